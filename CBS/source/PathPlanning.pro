@@ -7,8 +7,9 @@
 TARGET = MultiAgentSearch
 CONFIG   += console
 CONFIG   -= app_bundle
+CONFIG   += thread
 TEMPLATE = app
-QMAKE_CXXFLAGS += -std=c++11 -Wall
+QMAKE_CXXFLAGS += -std=c++17 -Wall
 
 
 #QMAKE_CXXFLAGS += -O0
@@ -24,14 +25,20 @@ SOURCES += \
     agent.cpp \
     agent_set.cpp \
     anytime_cbs.cpp \
+    bucket_queue.cpp \
+    closed_table.cpp \
     conflict_avoidance_table.cpp \
     conflict_based_search.cpp \
     conflict_set.cpp \
     constraints_set.cpp \
     focal_lpa_star.cpp \
+    focal_queue.cpp \
     focalsearch.cpp \
+    indexed_heap_queue.cpp \
     lpa_star.cpp \
     mdd.cpp \
+    path_table.cpp \
+    perfect_heuristic.cpp \
     prioritized_planning.cpp \
     push_and_rotate.cpp \
     replanning_astar.cpp \
@@ -39,7 +46,9 @@ SOURCES += \
     scipp.cpp \
     search_queue.cpp \
     sipp.cpp \
+    symmetry_reasoning.cpp \
     tinyxml2.cpp \
+    wdg_heuristic.cpp \
     xmllogger.cpp \
     isearch.cpp \
     mission.cpp \
@@ -55,7 +64,10 @@ HEADERS += \
     agent_move.h \
     agent_set.h \
     anytime_cbs.h \
+    bitboard.h \
+    bucket_queue.h \
     cbs_node.h \
+    closed_table.h \
     conflict.h \
     conflict_avoidance_table.h \
     conflict_based_search.h \
@@ -64,13 +76,18 @@ HEADERS += \
     constraints_set.h \
     flpa_node.h \
     focal_lpa_star.h \
+    focal_queue.h \
     focalsearch.h \
     fs_node.h \
+    indexed_heap_queue.h \
     lpa_node.h \
     lpa_star.h \
     mdd.h \
     multiagent_search_interface.h \
     multiagent_search_result.h \
+    path.h \
+    path_table.h \
+    perfect_heuristic.h \
     prioritized_planning.h \
     push_and_rotate.h \
     replanning_astar.h \
@@ -79,11 +96,16 @@ HEADERS += \
     replanning_fs_node.h \
     scipp.h \
     scipp_node.h \
+    search_engine.h \
+    search_node.h \
     search_queue.h \
     sipp.h \
     sipp_node.h \
+    successor_buffer.h \
+    symmetry_reasoning.h \
     testing_results.h \
     tinyxml2.h \
+    wdg_heuristic.h \
     node.h \
     gl_const.h \
     xmllogger.h \
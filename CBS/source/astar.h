@@ -1,10 +1,11 @@
 #ifndef ASTAR_H
 #define ASTAR_H
 #include "dijkstra.h"
+#include "perfect_heuristic.h"
 
 //A* search.
-template <typename NodeType = Node>
-class Astar : public Dijkstra<NodeType>
+template <typename NodeType = Node, typename QueueType = SearchQueue<NodeType>>
+class Astar : public Dijkstra<NodeType, QueueType>
 {
     public:
         Astar(bool WithTime = false, double HW = 1.0, bool BT = true);
@@ -13,12 +14,12 @@ class Astar : public Dijkstra<NodeType>
         Astar(Astar&& other) = default;
         Astar& operator=(Astar&& other) = default;
         virtual ~Astar() = default;
-        void setPerfectHeuristic(std::unordered_map<std::pair<Node, Node>, int>* PerfectHeuristic) {
-            perfectHeuristic = PerfectHeuristic;
+        void setPerfectHeuristic(const PerfectHeuristic* Heuristic) {
+            perfectHeuristic = Heuristic;
         }
         double computeHFromCellToCell(int i1, int j1, int i2, int j2) override;
 
-        std::unordered_map<std::pair<Node, Node>, int>* perfectHeuristic = nullptr;
+        const PerfectHeuristic* perfectHeuristic = nullptr;
 
     protected:
         double euclideanDistance(int x1, int y1, int x2, int y2);
@@ -0,0 +1,106 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <vector>
+#include <cstdint>
+
+// Set of cells of a rectangle of the grid with a bit per cell. Every row takes rowWords 64-bit words and cell (i, j)
+// is bit j % 64 of word i * rowWords + j / 64, so the cells reachable in one move from all cells of a set
+// are found by shifts and ors of whole words.
+class Bitboard
+{
+public:
+    Bitboard(int height = 0, int width = 0)
+        : height(height), width(width), rowWords((width + 63) / 64), words(height * rowWords, 0) {}
+    // the rectangle of other with the top left cell (top, left)
+    Bitboard(const Bitboard &other, int top, int left, int height, int width);
+
+    bool get(int i, int j) const { return words[i * rowWords + j / 64] >> (j % 64) & 1; }
+    void set(int i, int j) { words[i * rowWords + j / 64] |= uint64_t(1) << (j % 64); }
+    void reset(int i, int j) { words[i * rowWords + j / 64] &= ~(uint64_t(1) << (j % 64)); }
+    // number of cells in rows firstRow..lastRow
+    int count(int firstRow, int lastRow) const;
+
+    // rows firstRow..lastRow of res are set to the cells that are in this set or next to its cells
+    void expand(Bitboard &res, int firstRow, int lastRow) const;
+    // intersects rows firstRow..lastRow with other
+    void intersect(const Bitboard &other, int firstRow, int lastRow);
+
+    // calls f(i, j) for all cells of rows firstRow..lastRow of the set in order of rows and columns
+    template<typename F>
+    void forEach(F f, int firstRow, int lastRow) const;
+
+//private:
+    uint64_t getLastWordMask() const { return width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1; }
+
+    int                     height, width, rowWords;
+    std::vector<uint64_t>   words;
+};
+
+inline Bitboard::Bitboard(const Bitboard &other, int top, int left, int height, int width) : Bitboard(height, width) {
+    for (int i = 0; i < height; ++i) {
+        const uint64_t *src = &other.words[(top + i) * other.rowWords];
+        for (int w = 0; w < rowWords; ++w) {
+            int srcWord = (left + 64 * w) / 64, shift = (left + 64 * w) % 64;
+            uint64_t word = src[srcWord] >> shift;
+            if (shift != 0 && srcWord + 1 < other.rowWords) {
+                word |= src[srcWord + 1] << (64 - shift);
+            }
+            words[i * rowWords + w] = word;
+        }
+        words[i * rowWords + rowWords - 1] &= getLastWordMask();
+    }
+}
+
+inline int Bitboard::count(int firstRow, int lastRow) const {
+    int res = 0;
+    for (int k = firstRow * rowWords; k < (lastRow + 1) * rowWords; ++k) {
+        res += __builtin_popcountll(words[k]);
+    }
+    return res;
+}
+
+inline void Bitboard::expand(Bitboard &res, int firstRow, int lastRow) const {
+    uint64_t lastWordMask = getLastWordMask();
+    for (int i = firstRow; i <= lastRow; ++i) {
+        const uint64_t *row = &words[i * rowWords];
+        uint64_t *resRow = &res.words[i * rowWords];
+        for (int w = 0; w < rowWords; ++w) {
+            uint64_t word = row[w];
+            uint64_t cur = word | word << 1 | word >> 1;
+            if (w > 0) {
+                cur |= row[w - 1] >> 63;
+            }
+            if (w + 1 < rowWords) {
+                cur |= row[w + 1] << 63;
+            }
+            if (i > 0) {
+                cur |= row[w - rowWords];
+            }
+            if (i + 1 < height) {
+                cur |= row[w + rowWords];
+            }
+            resRow[w] = cur;
+        }
+        resRow[rowWords - 1] &= lastWordMask;
+    }
+}
+
+inline void Bitboard::intersect(const Bitboard &other, int firstRow, int lastRow) {
+    for (int k = firstRow * rowWords; k < (lastRow + 1) * rowWords; ++k) {
+        words[k] &= other.words[k];
+    }
+}
+
+template<typename F>
+void Bitboard::forEach(F f, int firstRow, int lastRow) const {
+    for (int i = firstRow; i <= lastRow; ++i) {
+        for (int w = 0; w < rowWords; ++w) {
+            for (uint64_t word = words[i * rowWords + w]; word != 0; word &= word - 1) {
+                f(i, 64 * w + __builtin_ctzll(word));
+            }
+        }
+    }
+}
+
+#endif // BITBOARD_H
@@ -0,0 +1,252 @@
+#include "bucket_queue.h"
+#include "indexed_heap_queue.h"
+#include "fs_node.h"
+#include "search_node.h"
+#include "sipp_node.h"
+
+
+template<typename NodeType>
+bool BucketQueue<NodeType>::insert(const Map& map, NodeType node, bool withTime, bool, NodeType) {
+    // old node is always taken from the store, withOld and old are kept for compatibility with SearchQueue
+    int key = node.convolution(map.getMapWidth(), map.getMapHeight(), withTime);
+    int f = node.F, h = f - node.g;
+    auto it = slotByIndex.find(key);
+    if (it != slotByIndex.end()) {
+        Slot &cur = slots[it->second];
+        if (f > cur.f || (f == cur.f && (node.conflictsCount > cur.conflicts ||
+                                         (node.conflictsCount == cur.conflicts && h >= cur.h)))) {
+            return false;
+        }
+        remove(it->second);
+        cur.node = node;
+        cur.f = f;
+        cur.conflicts = node.conflictsCount;
+        cur.h = h;
+        push(it->second);
+        return true;
+    }
+
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = slots.size();
+        slots.emplace_back();
+    }
+    slots[slot].node = node;
+    slots[slot].key = key;
+    slots[slot].f = f;
+    slots[slot].conflicts = node.conflictsCount;
+    slots[slot].h = h;
+    slotByIndex[key] = slot;
+    push(slot);
+    return true;
+}
+
+template<typename NodeType>
+void BucketQueue<NodeType>::erase(const Map& map, NodeType node, bool withTime) {
+    auto it = slotByIndex.find(node.convolution(map.getMapWidth(), map.getMapHeight(), withTime));
+    if (it == slotByIndex.end()) {
+        return;
+    }
+    int slot = it->second;
+    slotByIndex.erase(it);
+    remove(slot);
+    freeSlots.push_back(slot);
+}
+
+template<typename NodeType>
+NodeType BucketQueue<NodeType>::getByIndex(const Map& map, NodeType node, bool withTime) {
+    auto it = slotByIndex.find(node.convolution(map.getMapWidth(), map.getMapHeight(), withTime));
+    if (it == slotByIndex.end()) {
+        return NodeType(-1, -1);
+    }
+    return slots[it->second].node;
+}
+
+template<typename NodeType>
+template<typename OtherQueue>
+void BucketQueue<NodeType>::moveByUpperBound(OtherQueue& other, double threshold,
+                                             const Map& map, std::multiset<double>& otherF, bool withTime) {
+    while (count > 0 && minF <= threshold) {
+        int slot = frontSlot();
+        other.insert(map, slots[slot].node, withTime);
+        otherF.insert(slots[slot].node.F);
+        slotByIndex.erase(slots[slot].key);
+        remove(slot);
+        freeSlots.push_back(slot);
+    }
+}
+
+template<typename NodeType>
+template<typename OtherQueue>
+void BucketQueue<NodeType>::moveByLowerBound(OtherQueue& other, double threshold,
+                                             const Map& map, std::multiset<double>& FValues, bool withTime) {
+    for (int f = std::max(int(threshold) + 1, 0); f < buckets.size() && count > 0; ++f) {
+        for (Level &level : buckets[f].byConflicts) {
+            for (std::vector<int> &heap : level.byH) {
+                while (!heap.empty()) {
+                    int slot = heap.back();
+                    other.insert(map, slots[slot].node, withTime);
+                    FValues.erase(slots[slot].node.F);
+                    slotByIndex.erase(slots[slot].key);
+                    remove(slot);
+                    freeSlots.push_back(slot);
+                }
+            }
+        }
+    }
+}
+
+template<typename NodeType>
+NodeType BucketQueue<NodeType>::getFront() const {
+    return slots[frontSlot()].node;
+}
+
+template<typename NodeType>
+bool BucketQueue<NodeType>::empty() const {
+    return count == 0;
+}
+
+template<typename NodeType>
+int BucketQueue<NodeType>::size() const {
+    return count;
+}
+
+template<typename NodeType>
+void BucketQueue<NodeType>::clear() {
+    // buckets keep their capacity for the next search
+    for (int f = minF; f < int(buckets.size()) && count > 0; ++f) {
+        for (Level &level : buckets[f].byConflicts) {
+            for (std::vector<int> &heap : level.byH) {
+                count -= heap.size();
+                heap.clear();
+            }
+            level.minH = std::numeric_limits<int>::max();
+            level.count = 0;
+        }
+        buckets[f].minConflicts = std::numeric_limits<int>::max();
+        buckets[f].count = 0;
+    }
+    slots.clear();
+    freeSlots.clear();
+    slotByIndex.clear();
+    minF = std::numeric_limits<int>::max();
+    count = 0;
+}
+
+template<typename NodeType>
+void BucketQueue<NodeType>::push(int slot) {
+    Slot &s = slots[slot];
+    if (int(buckets.size()) <= s.f) {
+        buckets.resize(s.f + 1);
+    }
+    Bucket &bucket = buckets[s.f];
+    if (int(bucket.byConflicts.size()) <= s.conflicts) {
+        bucket.byConflicts.resize(s.conflicts + 1);
+    }
+    Level &level = bucket.byConflicts[s.conflicts];
+    if (int(level.byH.size()) <= s.h) {
+        level.byH.resize(s.h + 1);
+    }
+    level.byH[s.h].push_back(slot);
+    siftUp(level.byH[s.h], level.byH[s.h].size() - 1);
+    minF = std::min(minF, s.f);
+    bucket.minConflicts = std::min(bucket.minConflicts, s.conflicts);
+    level.minH = std::min(level.minH, s.h);
+    ++bucket.count;
+    ++level.count;
+    ++count;
+    skipEmpty();
+}
+
+template<typename NodeType>
+void BucketQueue<NodeType>::remove(int slot) {
+    const Slot &s = slots[slot];
+    Bucket &bucket = buckets[s.f];
+    Level &level = bucket.byConflicts[s.conflicts];
+    std::vector<int> &heap = level.byH[s.h];
+    int pos = s.pos, last = heap.back();
+    heap.pop_back();
+    if (pos < int(heap.size())) {
+        heap[pos] = last;
+        slots[last].pos = pos;
+        siftUp(heap, pos);
+        siftDown(heap, slots[last].pos);
+    }
+    --bucket.count;
+    --level.count;
+    --count;
+    skipEmpty();
+}
+
+template<typename NodeType>
+void BucketQueue<NodeType>::siftUp(std::vector<int>& heap, int pos) {
+    int slot = heap[pos];
+    while (pos > 0 && slots[heap[(pos - 1) / 2]].key > slots[slot].key) {
+        heap[pos] = heap[(pos - 1) / 2];
+        slots[heap[pos]].pos = pos;
+        pos = (pos - 1) / 2;
+    }
+    heap[pos] = slot;
+    slots[slot].pos = pos;
+}
+
+template<typename NodeType>
+void BucketQueue<NodeType>::siftDown(std::vector<int>& heap, int pos) {
+    int slot = heap[pos];
+    while (2 * pos + 1 < int(heap.size())) {
+        int child = 2 * pos + 1;
+        if (child + 1 < int(heap.size()) && slots[heap[child + 1]].key < slots[heap[child]].key) {
+            ++child;
+        }
+        if (slots[heap[child]].key >= slots[slot].key) {
+            break;
+        }
+        heap[pos] = heap[child];
+        slots[heap[pos]].pos = pos;
+        pos = child;
+    }
+    heap[pos] = slot;
+    slots[slot].pos = pos;
+}
+
+template<typename NodeType>
+void BucketQueue<NodeType>::skipEmpty() {
+    // minimums of the front bucket are kept exact, the other ones are only lower bounds
+    // and are moved forward once their bucket becomes the front one
+    if (count == 0) {
+        minF = std::numeric_limits<int>::max();
+        return;
+    }
+    while (buckets[minF].count == 0) {
+        buckets[minF].minConflicts = std::numeric_limits<int>::max();
+        ++minF;
+    }
+    Bucket &bucket = buckets[minF];
+    while (bucket.byConflicts[bucket.minConflicts].count == 0) {
+        bucket.byConflicts[bucket.minConflicts].minH = std::numeric_limits<int>::max();
+        ++bucket.minConflicts;
+    }
+    Level &level = bucket.byConflicts[bucket.minConflicts];
+    while (level.byH[level.minH].empty()) {
+        ++level.minH;
+    }
+}
+
+template<typename NodeType>
+int BucketQueue<NodeType>::frontSlot() const {
+    const Bucket &bucket = buckets[minF];
+    const Level &level = bucket.byConflicts[bucket.minConflicts];
+    return level.byH[level.minH][0];
+}
+
+template class BucketQueue<Node>;
+template class BucketQueue<FSNode>;
+template class BucketQueue<SearchNode>;
+template class BucketQueue<SIPPNode>;
+template void BucketQueue<FSNode>::moveByUpperBound(IndexedHeapQueue<FSNode>&, double,
+                                                    const Map&, std::multiset<double>&, bool);
+template void BucketQueue<SearchNode>::moveByUpperBound(IndexedHeapQueue<SearchNode>&, double,
+                                                        const Map&, std::multiset<double>&, bool);
@@ -0,0 +1,71 @@
+#ifndef BUCKETQUEUE_H
+#define BUCKETQUEUE_H
+
+#include "node.h"
+#include "map.h"
+#include <set>
+#include <vector>
+#include <limits>
+#include <unordered_map>
+
+// Replacement for SearchQueue when all costs are integer (unit-cost moves, Manhattan or perfect heuristic).
+// Nodes are bucketed by F, inside by conflictsCount and then by H (smaller H means greater g),
+// nodes with equal keys are kept in a small heap by cell. Insert, erase and pop take O(1) bucket operations.
+// Unlike SearchQueue it takes no comparator: the order above is the one of OPEN with CAT,
+// and without CAT all conflictsCount are zero, so it is the default order.
+template <typename NodeType = Node>
+class BucketQueue
+{
+public:
+    bool insert(const Map& map, NodeType node, bool withTime,
+                bool withOld = false, NodeType old = NodeType(-1, -1));
+    void erase(const Map& map, NodeType node, bool withTime);
+    template<typename OtherQueue>
+    void moveByUpperBound(OtherQueue& other, double threshold,
+        const Map& map, std::multiset<double>& otherF, bool withTime = false);
+    template<typename OtherQueue>
+    void moveByLowerBound(OtherQueue& other, double threshold,
+        const Map& map, std::multiset<double>& FValues, bool withTime = false);
+    NodeType getByIndex(const Map& map, NodeType node, bool withTime);
+    NodeType getFront() const;
+    bool empty() const;
+    int size() const;
+    void clear();
+
+//private:
+    struct Level
+    {
+        std::vector<std::vector<int>>   byH;
+        int                             minH = std::numeric_limits<int>::max();
+        int                             count = 0;
+    };
+
+    struct Bucket
+    {
+        std::vector<Level>  byConflicts;
+        int                 minConflicts = std::numeric_limits<int>::max();
+        int                 count = 0;
+    };
+
+    struct Slot
+    {
+        NodeType    node;
+        int         key, f, conflicts, h, pos;
+    };
+
+    void push(int slot);
+    void remove(int slot);
+    void siftUp(std::vector<int>& heap, int pos);
+    void siftDown(std::vector<int>& heap, int pos);
+    void skipEmpty();
+    int frontSlot() const;
+
+    std::vector<Bucket>             buckets;
+    std::vector<Slot>               slots;
+    std::vector<int>                freeSlots;
+    std::unordered_map<int, int>    slotByIndex;
+    int                             minF = std::numeric_limits<int>::max();
+    int                             count = 0;
+};
+
+#endif // BUCKETQUEUE_H
@@ -3,10 +3,11 @@
 
 #include <vector>
 #include <unordered_map>
-#include <list>
 #include <memory>
 #include "node.h"
+#include "path.h"
 #include "constraint.h"
+#include "constraints_set.h"
 #include "mdd.h"
 #include "conflict_set.h"
 
@@ -16,15 +17,18 @@ struct CBSNode
     static int curId;
 
     Constraint                                  constraint, positiveConstraint;
-    std::unordered_map<int, std::list<Node>>    paths;
+    std::unordered_map<int, Path>               paths;
     std::unordered_map<int, MDD>                mdds;
     std::unordered_map<int, double>             lb;
+    std::unordered_map<int, ConstraintsList>    constraints; // lists of the agents constrained in this node
     double                                      sumLb;
     int                                         hc;
     CBSNode*                                    parent;
+    std::unordered_map<int, CBSNode*>           prevPathNodes; // hold the paths of the agents before this node
     ConflictSet                                 conflictSet;
     int                                         cost;
     int                                         id;
+    int                                         depth = 0;
     int                                         H, G;
     bool                                        hasPositiveConstraint;
     bool                                        pathFound;
@@ -55,4 +59,20 @@ struct CBSNode
     }
 };
 
+template <typename SearchType = Astar<>>
+struct CBSNodePtrLess
+{
+    bool operator()(const CBSNode<SearchType> *lhs, const CBSNode<SearchType> *rhs) const {
+        return *lhs < *rhs;
+    }
+};
+
+template <typename SearchType = Astar<>>
+struct CBSNodeLbLess
+{
+    bool operator()(const CBSNode<SearchType> *lhs, const CBSNode<SearchType> *rhs) const {
+        return lhs->sumLb < rhs->sumLb || (lhs->sumLb == rhs->sumLb && lhs->id < rhs->id);
+    }
+};
+
 #endif // CBS_NODE_H
@@ -0,0 +1,100 @@
+#include "closed_table.h"
+#include "fs_node.h"
+#include "search_node.h"
+#include "sipp_node.h"
+
+
+template<typename NodeType>
+int ClosedTable<NodeType>::insert(const Map& map, const NodeType& node, bool withTime) {
+    if (nodesCount == 0 && (width != map.getMapWidth() || height != map.getMapHeight())) {
+        resetLayers(map);
+    }
+    int layer = withTime ? getTimeLayer(node) : 0;
+    while (int(layers.size()) <= layer) {
+        layers.emplace_back(tilesCount, -1);
+    }
+    int &tile = layers[layer][(node.i / tileSide) * tilesInRow + node.j / tileSide];
+    if (tile == -1) {
+        tile = slots.size();
+        slots.resize(slots.size() + tileSide * tileSide);
+    }
+    Slot &slot = slots[tile + (node.i % tileSide) * tileSide + node.j % tileSide];
+    if (slot.generation != generation) {
+        slot.generation = generation;
+        slot.index = nodesCount++;
+        if (slot.index == int(nodes.size())) {
+            nodes.push_back(node);
+            return slot.index;
+        }
+    }
+    nodes[slot.index] = node;
+    return slot.index;
+}
+
+template<typename NodeType>
+NodeType* ClosedTable<NodeType>::find(const Map&, const NodeType& node, bool withTime) {
+    const Slot *slot = getSlot(withTime ? getTimeLayer(node) : 0, node.i, node.j);
+    if (slot == nullptr || slot->generation != generation) {
+        return nullptr;
+    }
+    return &nodes[slot->index];
+}
+
+template<typename NodeType>
+NodeType& ClosedTable<NodeType>::getNode(int index) {
+    return nodes[index];
+}
+
+template<typename NodeType>
+const NodeType& ClosedTable<NodeType>::getNode(int index) const {
+    return nodes[index];
+}
+
+template<typename NodeType>
+bool ClosedTable<NodeType>::contains(const Map&, const NodeType& node, bool withTime) const {
+    const Slot *slot = getSlot(withTime ? getTimeLayer(node) : 0, node.i, node.j);
+    return slot != nullptr && slot->generation == generation;
+}
+
+template<typename NodeType>
+int ClosedTable<NodeType>::size() const {
+    return nodesCount;
+}
+
+template<typename NodeType>
+void ClosedTable<NodeType>::clear() {
+    nodesCount = 0;
+    if (++generation == 0) {
+        std::fill(slots.begin(), slots.end(), Slot());
+        generation = 1;
+    }
+}
+
+template<typename NodeType>
+const typename ClosedTable<NodeType>::Slot* ClosedTable<NodeType>::getSlot(int layer, int i, int j) const {
+    if (nodesCount == 0 || layer >= int(layers.size())) {
+        return nullptr;
+    }
+    int tile = layers[layer][(i / tileSide) * tilesInRow + j / tileSide];
+    if (tile == -1) {
+        return nullptr;
+    }
+    return &slots[tile + (i % tileSide) * tileSide + j % tileSide];
+}
+
+template<typename NodeType>
+void ClosedTable<NodeType>::resetLayers(const Map& map) {
+    layers.clear();
+    slots.clear();
+    nodes.clear();
+    nodesCount = 0;
+    width = map.getMapWidth();
+    height = map.getMapHeight();
+    tilesInRow = (width + tileSide - 1) / tileSide;
+    tilesCount = tilesInRow * ((height + tileSide - 1) / tileSide);
+}
+
+template class ClosedTable<Node>;
+template class ClosedTable<FSNode>;
+template class ClosedTable<SearchNode>;
+template class ClosedTable<SIPPNode>;
@@ -0,0 +1,51 @@
+#ifndef CLOSEDTABLE_H
+#define CLOSEDTABLE_H
+
+#include "node.h"
+#include "map.h"
+#include <deque>
+#include <algorithm>
+#include <vector>
+
+// CLOSE list of the low level search without hashing. Nodes are addressed by (time layer, cell id),
+// same as Node::convolution. Every layer is a flat directory of 8x8 cell tiles, layers are added one at a time
+// and tiles are taken from a common slot pool on first write, so long time-expanded searches on big maps stay cheap in memory.
+// Every slot carries the generation of the search that wrote it, so clear() only starts a new generation.
+// Closed nodes are kept in a deque, so it is also the node pool of the search: insert() returns the index
+// of the node in the pool, the index and the pointer to the node stay valid until the next clear().
+template <typename NodeType = Node>
+class ClosedTable
+{
+public:
+    int insert(const Map& map, const NodeType& node, bool withTime);
+    NodeType* find(const Map& map, const NodeType& node, bool withTime);
+    NodeType& getNode(int index);
+    const NodeType& getNode(int index) const;
+    bool contains(const Map& map, const NodeType& node, bool withTime) const;
+    int size() const;
+    void clear();
+
+//private:
+    static const int tileSide = 8;
+
+    struct Slot
+    {
+        unsigned    generation = 0;
+        int         index = -1;
+    };
+
+    const Slot* getSlot(int layer, int i, int j) const;
+    void resetLayers(const Map& map);
+
+    std::vector<std::vector<int>>   layers;
+    std::vector<Slot>               slots;
+    std::deque<NodeType>            nodes;
+    int                             nodesCount = 0;
+    int                             tilesInRow = 0;
+    int                             tilesCount = 0;
+    int                             width = 0;
+    int                             height = 0;
+    unsigned                        generation = 1;
+};
+
+#endif // CLOSEDTABLE_H
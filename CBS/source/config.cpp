@@ -101,17 +101,27 @@ bool Config::getConfig(const char *FileName)
     getValueFromText(options, CNS_TAG_AGENTS_STEP, "int", &agentsStep);
     getValueFromText(options, CNS_TAG_FIRST_TASK, "int", &firstTask);
 
+    tinyxml2::XMLElement *cache = getChild(options, CNS_TAG_H_CACHE, false);
+    if (cache && cache->GetText()) {
+#ifdef _WIN32
+        std::cout << "Warning! '" << CNS_TAG_H_CACHE << "' is supported on POSIX systems only, it is ignored." << std::endl;
+#else
+        heuristicCache = cache->GetText();
+#endif
+    }
+
     algorithm = getChild(root, CNS_TAG_ALG);
     if (!algorithm) {
         return false;
     }
 
     success = success && getText(algorithm, CNS_TAG_PLANNER, value);
-    if (value == CNS_ST_CBS || value == CNS_ST_ECBS) {
+    if (value == CNS_ST_CBS || value == CNS_ST_ECBS || value == CNS_ST_EECBS) {
         searchType = CN_ST_CBS;
-        if (value == CNS_ST_ECBS) {
+        if (value == CNS_ST_ECBS || value == CNS_ST_EECBS) {
             withFocalSearch = true;
         }
+        withExplicitEstimation = value == CNS_ST_EECBS;
     } else {
         std::cout << "Error! Planner name '" << value << "' is unknown." << std::endl;
         return false;
@@ -129,13 +139,15 @@ bool Config::getConfig(const char *FileName)
         lowLevel = CN_SP_ST_ASTAR;
     } else if (lowLevelSearch == CNS_SP_ST_FS) {
         lowLevel = CN_SP_ST_FS;
+    } else if (lowLevelSearch == CNS_SP_ST_SIPP) {
+        lowLevel = CN_SP_ST_SIPP;
     } else {
         std::cout << "Error! Low level search '" << lowLevelSearch << "' is unknown." << std::endl;
         return false;
     }
 
     if (searchType == CN_ST_CBS && !withFocalSearch &&
-        lowLevel != CN_SP_ST_ASTAR)
+        lowLevel != CN_SP_ST_ASTAR && lowLevel != CN_SP_ST_SIPP)
     {
         std::cout << "Warning! Specified low level search can not be used in this algorithm. Using A* instead." << std::endl;
         lowLevel = CN_SP_ST_ASTAR;
@@ -146,13 +158,24 @@ bool Config::getConfig(const char *FileName)
     getValueFromText(algorithm, CNS_TAG_CARD_CONF, "bool", &withCardinalConflicts);
     getValueFromText(algorithm, CNS_TAG_BYPASSING, "bool", &withBypassing);
     getValueFromText(algorithm, CNS_TAG_WITH_MH, "bool", &withMatchingHeuristic);
+    getValueFromText(algorithm, CNS_TAG_WITH_DG, "bool", &withDGHeuristic);
+    getValueFromText(algorithm, CNS_TAG_WITH_WDG, "bool", &withWDGHeuristic);
+    getValueFromText(algorithm, CNS_TAG_WITH_CR, "bool", &withCorridorReasoning);
+    getValueFromText(algorithm, CNS_TAG_WITH_RR, "bool", &withRectangleReasoning);
+    getValueFromText(algorithm, CNS_TAG_WITH_TR, "bool", &withTargetReasoning);
+    getValueFromText(algorithm, CNS_TAG_MERGE_TH, "int", &mergeThreshold);
     getValueFromText(algorithm, CNS_TAG_WITH_DS, "bool", &withDisjointSplitting);
     getValueFromText(algorithm, CNS_TAG_FOCAL_W, "double", &focalW);
     getValueFromText(algorithm, CNS_TAG_RC, "bool", &useCatAtRoot);
     getValueFromText(algorithm, CNS_TAG_LL_RFS, "int", &lowLevelRestartFrequency);
 
-    storeConflicts = withFocalSearch || withBypassing || withMatchingHeuristic || withDisjointSplitting;
-    withCardinalConflicts = withCardinalConflicts || withMatchingHeuristic || withDisjointSplitting;
+    if (withFocalSearch) {
+        mergeThreshold = -1;
+    }
+    storeConflicts = withFocalSearch || withBypassing || withMatchingHeuristic ||
+                     withDGHeuristic || withWDGHeuristic || withDisjointSplitting;
+    withCardinalConflicts = withCardinalConflicts || withMatchingHeuristic ||
+                            withDGHeuristic || withWDGHeuristic || withDisjointSplitting || withRectangleReasoning;
     return true;
 }
 
@@ -22,13 +22,21 @@ class Config
         int             tasksCount = 1;
         bool            withCAT = false;
         bool            withPerfectHeuristic = false;
+        std::string     heuristicCache;
         bool            singleExecution = false;
         bool            withCardinalConflicts = false;
         bool            withBypassing = false;
         bool            withMatchingHeuristic = false;
+        bool            withDGHeuristic = false;
+        bool            withWDGHeuristic = false;
+        bool            withCorridorReasoning = false;
+        bool            withRectangleReasoning = false;
+        bool            withTargetReasoning = false;
+        int             mergeThreshold = -1;
         bool            storeConflicts = false;
         bool            withDisjointSplitting = false;
         bool            withFocalSearch = false;
+        bool            withExplicitEstimation = false;
         bool            saveAggregatedResults = true;
         bool            useCatAtRoot = true;
         int             lowLevelRestartFrequency = 10000000;
@@ -7,9 +7,11 @@ struct Conflict {
     Node pos1, pos2;
     int time;
     bool edgeConflict;
+    bool targetConflict;  // one of the agents has reached its goal and stays there
     bool conflictFound;
 
     Conflict(bool ConflictFound = false) {
+        targetConflict = false;
         conflictFound = ConflictFound;
     }
 
@@ -20,6 +22,7 @@ struct Conflict {
         pos2 = Pos2;
         time = Time;
         edgeConflict = EdgeConflict;
+        targetConflict = false;
         conflictFound = true;
     }
 };
@@ -1,132 +1,159 @@
 #include "conflict_avoidance_table.h"
 
-void ConflictAvoidanceTable::addNode(const Node &node) {
-    auto tuple = std::make_tuple(node.i, node.j, node.g);
-    if (nodeAgentsCount.find(tuple) == nodeAgentsCount.end()) {
-        nodeAgentsCount[tuple] = 1;
-    } else {
-        ++nodeAgentsCount[tuple];
+ConflictAvoidanceTable::CellCounts& ConflictAvoidanceTable::getCell(int i, int j) {
+    if (2 * (cells.size() + 1) > table.size()) {
+        rehash(std::max<int>(64, 2 * table.size()));
+    }
+    int slot = findSlot(i, j);
+    if (table[slot] == -1) {
+        table[slot] = cells.size();
+        cells.push_back(CellCounts{i, j, CN_INFINITY, 0, {}});
+    }
+    return cells[table[slot]];
+}
+
+void ConflictAvoidanceTable::rehash(int tableSize) {
+    table.assign(tableSize, -1);
+    for (int k = 0; k < int(cells.size()); ++k) {
+        table[findSlot(cells[k].i, cells[k].j)] = k;
     }
 }
 
+ConflictAvoidanceTable::TimeCounts& ConflictAvoidanceTable::getCounts(int i, int j, int time) {
+    CellCounts &cell = getCell(i, j);
+    if (cell.counts.empty()) {
+        cell.beginTime = time;
+    } else if (time < cell.beginTime) {
+        cell.counts.insert(cell.counts.begin(), cell.beginTime - time, TimeCounts());
+        cell.beginTime = time;
+    }
+    if (time - cell.beginTime >= int(cell.counts.size())) {
+        cell.counts.resize(time - cell.beginTime + 1);
+    }
+    return cell.counts[time - cell.beginTime];
+}
+
+void ConflictAvoidanceTable::addNode(const Node &node) {
+    ++getCounts(node.i, node.j, node.g).nodes;
+}
+
 void ConflictAvoidanceTable::addGoalNode(const Node &node) {
-    goalNodeAgentsCount[std::make_pair(node.i, node.j)] = node.g;
+    getCell(node.i, node.j).goalTime = node.g;
 }
 
 void ConflictAvoidanceTable::addEdge(const Node &node, const Node &prev) {
-    auto tuple = std::make_tuple(prev.i, prev.j, node.i, node.j, node.g);
-    if (edgeAgentsCount.find(tuple) == edgeAgentsCount.end()) {
-        edgeAgentsCount[tuple] = 1;
-    } else {
-        ++edgeAgentsCount[tuple];
+    // the move is stored in the cell it starts from, where it is looked up by getAgentsCount of the opposite move
+    int dir = getDirection(prev.i, prev.j, node.i, node.j);
+    if (dir != -1) {
+        ++getCounts(prev.i, prev.j, node.g).edges[dir];
     }
 }
 
-void ConflictAvoidanceTable::addAgentPath(const std::list<Node>::const_iterator& start,
-                                          const std::list<Node>::const_iterator& end) {
-    for (auto it = start; it != end; ++it) {
-        if (std::next(it) == end) {
-            addGoalNode(*it);
+void ConflictAvoidanceTable::addAgentPath(const Path &path) {
+    for (int time = 0; time < path.size(); ++time) {
+        int i = path.getI(time), j = path.getJ(time);
+        if (time + 1 == path.size()) {
+            getCell(i, j).goalTime = time;
         } else {
-            addNode(*it);
+            ++getCounts(i, j, time).nodes;
         }
-        if (it != start && *it != *std::prev(it)) {
-            addEdge(*it, *std::prev(it));
+        if (time > 0 && path.getCell(time) != path.getCell(time - 1)) {
+            int prevI = path.getI(time - 1), prevJ = path.getJ(time - 1);
+            int dir = getDirection(prevI, prevJ, i, j);
+            if (dir != -1) {
+                ++getCounts(prevI, prevJ, time).edges[dir];
+            }
         }
     }
 }
 
 void ConflictAvoidanceTable::removeNode(const Node &node) {
-    auto tuple = std::make_tuple(node.i, node.j, node.g);
-    if (nodeAgentsCount[tuple] == 1) {
-        nodeAgentsCount.erase(tuple);
-    } else {
-        --nodeAgentsCount[tuple];
-    }
+    --getCounts(node.i, node.j, node.g).nodes;
 }
 
 void ConflictAvoidanceTable::removeGoalNode(const Node &node) {
-    goalNodeAgentsCount.erase(std::make_pair(node.i, node.j));
+    getCell(node.i, node.j).goalTime = CN_INFINITY;
 }
 
 void ConflictAvoidanceTable::removeEdge(const Node &node, const Node &prev) {
-    auto tuple = std::make_tuple(prev.i, prev.j, node.i, node.j, node.g);
-    if (edgeAgentsCount[tuple] == 1) {
-        edgeAgentsCount.erase(tuple);
-    } else {
-        --edgeAgentsCount[tuple];
+    int dir = getDirection(prev.i, prev.j, node.i, node.j);
+    if (dir != -1) {
+        --getCounts(prev.i, prev.j, node.g).edges[dir];
     }
 }
 
-void ConflictAvoidanceTable::removeAgentPath(const std::list<Node>::const_iterator& start,
-                                             const std::list<Node>::const_iterator& end) {
-    for (auto it = start; it != end; ++it) {
-        if (std::next(it) == end) {
-            removeGoalNode(*it);
+void ConflictAvoidanceTable::removeAgentPath(const Path &path) {
+    for (int time = 0; time < path.size(); ++time) {
+        int i = path.getI(time), j = path.getJ(time);
+        if (time + 1 == path.size()) {
+            getCell(i, j).goalTime = CN_INFINITY;
         } else {
-            removeNode(*it);
+            --getCounts(i, j, time).nodes;
         }
-        if (it != start && *it != *std::prev(it)) {
-            removeEdge(*it, *std::prev(it));
+        if (time > 0 && path.getCell(time) != path.getCell(time - 1)) {
+            int prevI = path.getI(time - 1), prevJ = path.getJ(time - 1);
+            int dir = getDirection(prevI, prevJ, i, j);
+            if (dir != -1) {
+                --getCounts(prevI, prevJ, time).edges[dir];
+            }
         }
     }
 }
 
 int ConflictAvoidanceTable::getAgentsCount(const Node &node, const Node &prev) const {
-    int res = 0;
-    auto nodeTuple = std::make_tuple(node.i, node.j, node.g);
-    if (nodeAgentsCount.find(nodeTuple) != nodeAgentsCount.end()) {
-        res += nodeAgentsCount.at(nodeTuple);
-    }
-    auto edgeTuple = std::make_tuple(node.i, node.j, prev.i, prev.j, node.g);
-    if (edgeAgentsCount.find(edgeTuple) != edgeAgentsCount.end()) {
-        res += edgeAgentsCount.at(edgeTuple);
-    }
-
-    auto it = goalNodeAgentsCount.find(std::make_pair(node.i, node.j));
-    if (it != goalNodeAgentsCount.end() && it->second <= node.g) {
-        ++res;
-    }
-    return res;
+    return getAgentsCount(node.i, node.j, node.g, prev.i, prev.j);
 }
 
 int ConflictAvoidanceTable::getNodeAgentsCount(const Node &node) const {
-    int res = 0;
-    auto nodeTuple = std::make_tuple(node.i, node.j, node.g);
-    if (nodeAgentsCount.find(nodeTuple) != nodeAgentsCount.end()) {
-        res += nodeAgentsCount.at(nodeTuple);
+    const CellCounts *cell = findCell(node.i, node.j);
+    if (cell == nullptr) {
+        return 0;
     }
-    auto it = goalNodeAgentsCount.find(std::make_pair(node.i, node.j));
-    if (it != goalNodeAgentsCount.end() && it->second <= node.g) {
-        ++res;
+    int res = cell->goalTime <= node.g ? 1 : 0;
+    const TimeCounts *counts = cell->getCounts(node.g);
+    if (counts != nullptr) {
+        res += counts->nodes;
     }
     return res;
 }
 
 int ConflictAvoidanceTable::getEdgeAgentsCount(const Node &node, const Node &prev) const {
-    auto edgeTuple = std::make_tuple(node.i, node.j, prev.i, prev.j, node.g);
-    if (edgeAgentsCount.find(edgeTuple) != edgeAgentsCount.end()) {
-        return edgeAgentsCount.at(edgeTuple);
+    const CellCounts *cell = findCell(node.i, node.j);
+    int dir = getDirection(node.i, node.j, prev.i, prev.j);
+    if (cell == nullptr || dir == -1) {
+        return 0;
     }
-    return 0;
+    const TimeCounts *counts = cell->getCounts(node.g);
+    return counts == nullptr ? 0 : counts->edges[dir];
 }
 
 int ConflictAvoidanceTable::getFirstSoftConflict(const Node & node, int startTime, int endTime) const {
-    auto nodeIt = nodeAgentsCount.lower_bound(std::make_tuple(node.i, node.j, startTime));
-    if (nodeIt != nodeAgentsCount.end() && std::get<0>(nodeIt->first) == node.i
-            && std::get<1>(nodeIt->first) == node.j && std::get<2>(nodeIt->first) <= endTime) {
-        return std::get<2>(nodeIt->first);
+    const CellCounts *cell = findCell(node.i, node.j);
+    if (cell == nullptr) {
+        return -1;
+    }
+    int last = std::min<int>(endTime, cell->beginTime + cell->counts.size() - 1);
+    for (int time = std::max(startTime, cell->beginTime); time <= last; ++time) {
+        if (cell->counts[time - cell->beginTime].nodes > 0) {
+            return time;
+        }
     }
     return -1;
 }
 
 int ConflictAvoidanceTable::getFutureConflictsCount(const Node & node, int time) const {
+    return getFutureConflictsCount(node.i, node.j, time);
+}
+
+int ConflictAvoidanceTable::getFutureConflictsCount(int i, int j, int time) const {
     return 0;
+    const CellCounts *cell = findCell(i, j);
+    if (cell == nullptr) {
+        return 0;
+    }
     int res = 0;
-    auto it = nodeAgentsCount.upper_bound(std::make_tuple(node.i, node.j, time));
-    for (; it != nodeAgentsCount.end() && std::get<0>(it->first) == node.i
-                                   && std::get<1>(it->first) == node.j; ++it) {
-        res += it->second;
+    for (int k = std::max(0, time + 1 - cell->beginTime); k < int(cell->counts.size()); ++k) {
+        res += cell->counts[k].nodes;
     }
     return res;
 }
@@ -134,11 +161,16 @@ int ConflictAvoidanceTable::getFutureConflictsCount(const Node & node, int time)
 void ConflictAvoidanceTable::getSoftConflictIntervals(std::vector<std::pair<int, int>> &res,
                                                       const Node & node, const Node &prevNode,
                                                       int startTime, int endTime, bool binary) const {
-    std::map<int, int> agentsCount;
-    auto nodeIt = nodeAgentsCount.lower_bound(std::make_tuple(node.i, node.j, startTime));
-    auto nodeEnd = nodeAgentsCount.upper_bound(std::make_tuple(node.i, node.j, endTime));
-    for (nodeIt; nodeIt != nodeEnd; ++nodeIt) {
-        agentsCount[std::get<2>(nodeIt->first)] = nodeIt->second;
+    const CellCounts *cell = findCell(node.i, node.j);
+    std::vector<std::pair<int, int>> agentsCount;
+    if (cell != nullptr) {
+        int last = std::min<int>(endTime, cell->beginTime + cell->counts.size() - 1);
+        for (int time = std::max(startTime, cell->beginTime); time <= last; ++time) {
+            int count = cell->counts[time - cell->beginTime].nodes;
+            if (count > 0) {
+                agentsCount.emplace_back(time, count);
+            }
+        }
     }
 
     int count = 0, prevTime = startTime - 1, beg = -1;
@@ -163,14 +195,13 @@ void ConflictAvoidanceTable::getSoftConflictIntervals(std::vector<std::pair<int,
         res.emplace_back(prevTime + 1, 0);
     }
 
-    auto it = goalNodeAgentsCount.find(std::make_pair(node.i, node.j));
-    if (it != goalNodeAgentsCount.end()) {
+    if (cell != nullptr && cell->goalTime != CN_INFINITY) {
         int i;
-        for (i = 0; i < res.size() && res[i].first < it->second; ++i) {}
+        for (i = 0; i < res.size() && res[i].first < cell->goalTime; ++i) {}
 
-        if (i == res.size() || res[i].first > it->second) {
+        if (i == res.size() || res[i].first > cell->goalTime) {
             if (i > 0) {
-                res.insert(res.begin() + i, std::make_pair(it->second, res[i - 1].second + 1));
+                res.insert(res.begin() + i, std::make_pair(cell->goalTime, res[i - 1].second + 1));
                 ++i;
             }
         }
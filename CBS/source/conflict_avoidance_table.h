@@ -1,12 +1,16 @@
 #ifndef CONFLICTAVOIDANCETABLE_H
 #define CONFLICTAVOIDANCETABLE_H
 
-#include <unordered_map>
-#include <list>
+#include <vector>
 #include "node.h"
+#include "path.h"
 #include "map.h"
 #include "search_queue.h"
 
+// Paths of the agents indexed by cell. Every visited cell has an array of counts indexed by time, covering the times
+// at which the cell was visited: the number of agents in the cell and the number of agents moving from it
+// to each of 4 neighbours. Cells are found through a flat open addressing hash table keyed by (i, j),
+// so a lookup is one probe and one array access. Lookups on an empty table return right away.
 class ConflictAvoidanceTable
 {
 public:
@@ -14,13 +18,14 @@ public:
     void addEdge(const Node &node, const Node &prev);
     void removeNode(const Node &node);
     void removeEdge(const Node &node, const Node &prev);
-    void addAgentPath(const std::list<Node>::const_iterator& start,
-                      const std::list<Node>::const_iterator& end);
-    void removeAgentPath(const std::list<Node>::const_iterator& start,
-                         const std::list<Node>::const_iterator& end);
+    void addAgentPath(const Path &path);
+    void removeAgentPath(const Path &path);
     int getAgentsCount(const Node &node, const Node &prev) const;
+    // same as above for cell (i, j) at time entered from cell (prev_i, prev_j), does not need a Node
+    inline int getAgentsCount(int i, int j, int time, int prev_i, int prev_j) const;
     int getFirstSoftConflict(const Node & node, int startTime, int endTime) const;
     int getFutureConflictsCount(const Node & node, int time) const;
+    int getFutureConflictsCount(int i, int j, int time) const;
     void getSoftConflictIntervals(std::vector<std::pair<int, int>> &res, const Node & node, const Node &prevNode,
                                                           int startTime, int endTime, bool binary) const;
     int getEdgeAgentsCount(const Node &node, const Node &prev) const;
@@ -29,9 +34,79 @@ public:
     void removeGoalNode(const Node &node);
 
 private:
-    std::map<std::tuple<int, int, int>, int> nodeAgentsCount;
-    std::map<std::tuple<int, int, int, int, int>, int> edgeAgentsCount;
-    std::map<std::pair<int, int>, int> goalNodeAgentsCount;
+    struct TimeCounts
+    {
+        int nodes = 0;
+        int edges[4] = {0, 0, 0, 0};  // agents moving to the neighbour in direction getDirection
+    };
+
+    struct CellCounts
+    {
+        int                     i, j;
+        int                     goalTime;   // time from which an agent stays in the cell, CN_INFINITY if none
+        int                     beginTime;  // time of counts[0]
+        std::vector<TimeCounts> counts;
+
+        const TimeCounts* getCounts(int time) const {
+            int k = time - beginTime;
+            return k >= 0 && k < int(counts.size()) ? &counts[k] : nullptr;
+        }
+    };
+
+    // index of the move from (i, j) to (to_i, to_j), -1 if they are not neighbours
+    static int getDirection(int i, int j, int to_i, int to_j) {
+        int di = to_i - i, dj = to_j - j;
+        if (di == 0) {
+            return dj == -1 ? 0 : (dj == 1 ? 1 : -1);
+        }
+        if (dj == 0) {
+            return di == -1 ? 2 : (di == 1 ? 3 : -1);
+        }
+        return -1;
+    }
+
+    const CellCounts* findCell(int i, int j) const;
+    CellCounts& getCell(int i, int j);
+    TimeCounts& getCounts(int i, int j, int time);
+    int findSlot(int i, int j) const;
+    void rehash(int tableSize);
+
+    std::vector<CellCounts> cells;
+    std::vector<int>        table;  // indices of cells, -1 for empty slots, size is a power of two
 };
 
+inline int ConflictAvoidanceTable::findSlot(int i, int j) const {
+    int mask = table.size() - 1;
+    int slot = (unsigned(i) * 73856093u ^ unsigned(j) * 19349663u) & mask;
+    while (table[slot] != -1 && (cells[table[slot]].i != i || cells[table[slot]].j != j)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+inline const ConflictAvoidanceTable::CellCounts* ConflictAvoidanceTable::findCell(int i, int j) const {
+    if (cells.empty()) {
+        return nullptr;
+    }
+    int index = table[findSlot(i, j)];
+    return index == -1 ? nullptr : &cells[index];
+}
+
+inline int ConflictAvoidanceTable::getAgentsCount(int i, int j, int time, int prev_i, int prev_j) const {
+    const CellCounts *cell = findCell(i, j);
+    if (cell == nullptr) {
+        return 0;
+    }
+    int res = cell->goalTime <= time ? 1 : 0;
+    const TimeCounts *counts = cell->getCounts(time);
+    if (counts != nullptr) {
+        res += counts->nodes;
+        int dir = getDirection(i, j, prev_i, prev_j);
+        if (dir != -1) {
+            res += counts->edges[dir];
+        }
+    }
+    return res;
+}
+
 #endif
@@ -1,5 +1,7 @@
 #include "conflict_based_search.h"
 #include "focalsearch.h" // for templates
+#include "sipp.h"
+#include "search_engine.h"
 
 
 template<typename SearchType>
@@ -15,10 +17,10 @@ template<typename SearchType>
 ConflictBasedSearch<SearchType>::ConflictBasedSearch (SearchType *Search)
 {
     search = Search;
-    auto focalCmp = [](const CBSNode<SearchType> &lhs, const CBSNode<SearchType> &rhs) {
-        return lhs.hc < rhs.hc || (lhs.hc == rhs.hc && lhs < rhs);
+    auto focalCmp = [](const CBSNode<SearchType> *lhs, const CBSNode<SearchType> *rhs) {
+        return lhs->hc < rhs->hc || (lhs->hc == rhs->hc && *lhs < *rhs);
     };
-    focal = std::set<CBSNode<SearchType>, bool (*)(const CBSNode<SearchType>&, const CBSNode<SearchType>&)>(focalCmp);
+    focal = std::set<CBSNode<SearchType>*, bool (*)(const CBSNode<SearchType>*, const CBSNode<SearchType>*)>(focalCmp);
 }
 
 template<typename SearchType>
@@ -35,14 +37,187 @@ void ConflictBasedSearch<SearchType>::clear()
     close.clear();
     focal.clear();
     sumLb.clear();
+    nodes.clear();
     rootSearches.clear();
+    mddCache.clear();
+    wdgHeuristic.clear();
+    symmetryReasoning.clear();
+    metaAgents.clear();
+    metaAgentIds.clear();
+    costErrorSum = 0;
+    conflictsErrorSum = 0;
+    errorsCount = 0;
 }
 
 template<typename SearchType>
-std::list<Node> ConflictBasedSearch<SearchType>::getNewPath(const Map &map, const AgentSet &agentSet, const Agent &agent,
+ConflictSet ConflictBasedSearch<SearchType>::findConflict(const std::vector<const Path*> &paths,
+                                                          int agentId, bool findAllConflicts,
+                                                          bool withCardinalConflicts, const std::vector<MDD> &mdds,
+                                                          const PathTable *pathTable) {
+    ConflictSet conflictSet;
+    int agentCount = paths.size();
+    int makespan = 0;
+    for (const Path *path : paths) {
+        makespan = std::max(makespan, path->size());
+    }
+
+    // both functions return true if the search for conflicts is over
+    auto addVertexConflict = [&](int id1, int id2, int time) {
+        Conflict conflict(id1, id2, paths[id1]->getNode(time), paths[id1]->getNode(time), time, false);
+        conflict.targetConflict = time >= paths[id1]->getCost() || time >= paths[id2]->getCost();
+        int size1 = 0, size2 = 0;
+        if (withCardinalConflicts) {
+            size1 = mdds[id1].getLayerSize(time);
+            size2 = mdds[id2].getLayerSize(time);
+        }
+
+        if (size1 == 1 && size2 == 1) {
+            conflictSet.addCardinalConflict(conflict);
+            if (!findAllConflicts) {
+                return true;
+            }
+        } else if (size1 == 1 || size2 == 1) {
+            conflictSet.addSemiCardinalConflict(conflict);
+        } else {
+            conflictSet.addNonCardinalConflict(conflict);
+        }
+        return !findAllConflicts && !withCardinalConflicts;
+    };
+    auto addEdgeConflict = [&](int id1, int id2, int time) {
+        Conflict conflict(id1, id2, paths[id1]->getNode(time), paths[id1]->getNode(time + 1), time + 1, true);
+        int inSize1 = 0, outSize1 = 0, inSize2 = 0, outSize2 = 0;
+        if (withCardinalConflicts) {
+            inSize1 = mdds[id1].getLayerSize(time);
+            outSize1 = mdds[id1].getLayerSize(time + 1);
+            inSize2 = mdds[id2].getLayerSize(time);
+            outSize2 = mdds[id2].getLayerSize(time + 1);
+        }
+
+        if ((inSize1 == 1 && outSize1 == 1) && (inSize1 == 2 && outSize2 == 1)) {
+            conflictSet.addCardinalConflict(conflict);
+            if (!findAllConflicts) {
+                return true;
+            }
+        } else if ((inSize1 == 1 && outSize1 == 1) || (inSize2 == 1 && outSize2 == 1)) {
+            conflictSet.addSemiCardinalConflict(conflict);
+        } else {
+            conflictSet.addNonCardinalConflict(conflict);
+        }
+        return !findAllConflicts && !withCardinalConflicts;
+    };
+
+    if (agentId != -1 && pathTable != nullptr) {
+        // only the cells of the path of the agent are visited, other agents in them are taken from the table
+        const Path &path = *paths[agentId];
+        std::vector<int> agents;
+        for (int time = 0; time + 1 < path.size(); ++time) {
+            int cell = path.getCell(time), next = path.getCell(time + 1);
+            pathTable->getAgents(cell, time, agentId, agents);
+            for (int i : agents) {
+                if (addVertexConflict(agentId, i, time)) {
+                    return conflictSet;
+                }
+            }
+            pathTable->getAgents(next, time, agentId, agents);
+            for (int i : agents) {
+                if (time + 1 < paths[i]->size() && paths[i]->getCell(time + 1) == cell &&
+                        addEdgeConflict(agentId, i, time)) {
+                    return conflictSet;
+                }
+            }
+        }
+        // the agent stays in its last cell until the end of all paths
+        std::vector<std::pair<int, int>> timedAgents;
+        pathTable->getAgents(path.back(), path.getCost(), makespan, agentId, timedAgents);
+        for (auto &timedAgent : timedAgents) {
+            if (addVertexConflict(agentId, timedAgent.second, timedAgent.first)) {
+                return conflictSet;
+            }
+        }
+        return conflictSet;
+    }
+
+    if (agentId != -1) {
+        // cells of the agent are compared with the cells of other agents at the same time
+        const Path &path = *paths[agentId];
+        for (int time = 0; time < makespan; ++time) {
+            int cell = path.getCell(time);
+            for (int i = 0; i < agentCount; ++i) {
+                if (i != agentId && paths[i]->getCell(time) == cell && addVertexConflict(agentId, i, time)) {
+                    return conflictSet;
+                }
+            }
+            if (time + 1 < path.size()) {
+                int next = path.getCell(time + 1);
+                for (int i = 0; i < agentCount; ++i) {
+                    if (i != agentId && time + 1 < paths[i]->size() && paths[i]->getCell(time) == next &&
+                            paths[i]->getCell(time + 1) == cell && addEdgeConflict(agentId, i, time)) {
+                        return conflictSet;
+                    }
+                }
+            }
+        }
+        return conflictSet;
+    }
+
+    // agents in every cell at the current time as a linked list in the order of agents, a cell entry is valid
+    // only if it is tagged with the current time, so nothing is cleared between timesteps
+    struct CellAgents
+    {
+        int time = -1, first = -1, last = -1;
+    };
+    int height = 0, width = 0;
+    for (const Path *path : paths) {
+        for (int cell : path->cells) {
+            height = std::max(height, Path::unpackI(cell) + 1);
+            width = std::max(width, Path::unpackJ(cell) + 1);
+        }
+    }
+    std::vector<CellAgents> cellAgents(height * width);
+    std::vector<int> nextAgent(agentCount);
+    auto getIndex = [width](int cell) {
+        return Path::unpackI(cell) * width + Path::unpackJ(cell);
+    };
+    for (int time = 0; time < makespan; ++time) {
+        for (int i = 0; i < agentCount; ++i) {
+            int cell = paths[i]->getCell(time);
+            CellAgents &cur = cellAgents[getIndex(cell)];
+            if (cur.time == time) {
+                for (int j = cur.first; j != -1; j = nextAgent[j]) {
+                    if (addVertexConflict(i, j, time)) {
+                        return conflictSet;
+                    }
+                }
+                nextAgent[cur.last] = i;
+            } else {
+                cur.time = time;
+                cur.first = i;
+            }
+            cur.last = i;
+            nextAgent[i] = -1;
+
+            // a swap conflict is with an agent that is in the next cell now and moves to the current one
+            if (time + 1 < paths[i]->size()) {
+                int next = paths[i]->getCell(time + 1);
+                const CellAgents &other = cellAgents[getIndex(next)];
+                if (other.time == time) {
+                    for (int j = other.first; j != -1; j = nextAgent[j]) {
+                        if (j != i && time + 1 < paths[j]->size() && paths[j]->getCell(time + 1) == cell &&
+                                addEdgeConflict(i, j, time)) {
+                            return conflictSet;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return conflictSet;
+}
+
+template<typename SearchType>
+Path ConflictBasedSearch<SearchType>::getNewPath(const Map &map, const AgentSet &agentSet, const Agent &agent,
                                                 const Constraint &constraint, const ConstraintsSet &constraints,
-                                                const std::list<Node>::iterator pathStart,
-                                                const std::list<Node>::iterator pathEnd,
+                                                const Path &oldPath,
                                                 bool withCAT, const ConflictAvoidanceTable &CAT,
                                                 std::vector<double> &lb,
                                                 std::vector<int> &LLExpansions, std::vector<int> &LLNodes,
@@ -70,7 +245,7 @@ std::list<Node> ConflictBasedSearch<SearchType>::getNewPath(const Map &map, cons
                     positiveConstraints[i].i == constraint.i && positiveConstraints[i].j == constraint.j &&
                     (constraint.prev_i == -1 || (constraint.prev_i == positiveConstraints[i].prev_i &&
                      constraint.prev_j == positiveConstraints[i].prev_j))) {
-                    return std::list<Node>();
+                    return Path();
                 }
                 end = Node(positiveConstraints[i].prev_i, positiveConstraints[i].prev_j);
                 endTime = positiveConstraints[i].time - 1;
@@ -93,45 +268,124 @@ std::list<Node> ConflictBasedSearch<SearchType>::getNewPath(const Map &map, cons
     LLNodes.push_back(searchResult.nodescreated);
     LLExpansions.push_back(searchResult.nodesexpanded);
     if (!searchResult.pathfound) {
-        return std::list<Node>();
+        return Path();
     }
 
     double newLb = searchResult.minF;
-    std::list<Node> res;
+    Path res;
+    res.cells.reserve(std::max<int>(oldPath.size(), startTime + searchResult.lppath->size()));
     auto it1 = searchResult.lppath->begin();
     int time = 0;
-    for (auto it2 = pathStart; it2 != pathEnd && (endTime != -1 || it1 != searchResult.lppath->end()); ++it2) {
+    for (; time < oldPath.size() && (endTime != -1 || it1 != searchResult.lppath->end()); ++time) {
         if (time < startTime || (endTime != -1 && time > endTime)) {
-            res.push_back(*it2);
+            res.push_back(oldPath.getCell(time));
             ++newLb;
         } else {
-            res.push_back(*it1);
+            res.push_back(it1->i, it1->j);
             ++it1;
         }
-        ++time;
     }
     for (; time < startTime; ++time) {
-        res.push_back(*std::prev(pathEnd));
+        res.push_back(oldPath.back());
     }
     for (; it1 != searchResult.lppath->end(); ++it1) {
-        res.push_back(*it1);
+        res.push_back(it1->i, it1->j);
     }
     lb[agent.getId()] = newLb;
     return res;
 }
 
+template<typename SearchType>
+bool ConflictBasedSearch<SearchType>::getConstraints(const Map &map, const Config &config,
+    const ConflictSet &conflictSet, const std::vector<const Path*> &paths, const std::vector<MDD> &mdds,
+    const std::vector<ConstraintsList> &constraints, Conflict &conflict,
+    Constraint &constraint1, Constraint &constraint2)
+{
+    constraint1 = Constraint(conflict.pos2.i, conflict.pos2.j, conflict.time, conflict.id1);
+    constraint2 = Constraint(conflict.pos1.i, conflict.pos1.j, conflict.time, conflict.id2);
+    if (conflict.edgeConflict) {
+        constraint1.prev_i = conflict.pos1.i;
+        constraint1.prev_j = conflict.pos1.j;
+        constraint2.prev_i = conflict.pos2.i;
+        constraint2.prev_j = conflict.pos2.j;
+    }
+
+    // the reasonings need the agents to start in their starts and to be planned up to their goals at once,
+    // which positive constraints break
+    auto canUseReasoning = [&](const Conflict &cur) {
+        for (int id : {cur.id1, cur.id2}) {
+            for (const ConstraintsListNode *node = constraints[id].get(); node != nullptr; node = node->next.get()) {
+                if (node->constraint.positive) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    if (config.withTargetReasoning && conflict.targetConflict && canUseReasoning(conflict)) {
+        // agent 1 is the one in its goal, either its path ends after the time or no agent may be in its goal from then on
+        if (conflict.time < paths[conflict.id1]->getCost()) {
+            std::swap(conflict.id1, conflict.id2);
+            std::swap(conflict.pos1, conflict.pos2);
+        }
+        constraint1 = Constraint(conflict.pos1.i, conflict.pos1.j, conflict.time, conflict.id1);
+        constraint1.length = 1;
+        constraint2 = Constraint(conflict.pos1.i, conflict.pos1.j, conflict.time, conflict.id2, -1, -1, true);
+        return true;
+    }
+    if (config.withCorridorReasoning && canUseReasoning(conflict) &&
+            symmetryReasoning.getCorridorConstraints(map, conflict, *paths[conflict.id1], *paths[conflict.id2],
+                                                     constraint1, constraint2)) {
+        return true;
+    }
+    if (!config.withRectangleReasoning) {
+        return false;
+    }
+
+    // a rectangle has to block more MDDs than the conflict, so if it is not cardinal,
+    // rectangles of the other conflicts are looked for too
+    std::vector<Conflict> candidates = {conflict};
+    bool hasCardinal = conflictSet.getCardinalConflictCount() > 0;
+    if (!hasCardinal) {
+        std::vector<Conflict> semiCardinal = conflictSet.getSemiCardinalConflicts();
+        std::vector<Conflict> nonCardinal = conflictSet.getNonCardinalConflicts();
+        candidates.insert(candidates.end(), semiCardinal.begin(), semiCardinal.end());
+        candidates.insert(candidates.end(), nonCardinal.begin(), nonCardinal.end());
+    }
+    int maxBlocked = hasCardinal ? 1 : 0;
+    bool res = false;
+    for (const Conflict &candidate : candidates) {
+        if (candidate.edgeConflict || !canUseReasoning(candidate)) {
+            continue;
+        }
+        Constraint barrier1, barrier2;
+        int blocked = symmetryReasoning.getRectangleConstraints(candidate,
+            *paths[candidate.id1], *paths[candidate.id2], mdds[candidate.id1], mdds[candidate.id2],
+            barrier1, barrier2);
+        if (blocked > maxBlocked) {
+            conflict = candidate;
+            constraint1 = barrier1;
+            constraint2 = barrier2;
+            maxBlocked = blocked;
+            res = true;
+            if (blocked == 2) {
+                break;
+            }
+        }
+    }
+    return res;
+}
+
 template<typename SearchType>
 void ConflictBasedSearch<SearchType>::getState(
     const std::vector<int> &costs, int &oldCost,
-    const std::vector<std::list<Node>::iterator> &starts, std::list<Node>::iterator& oldStart,
-    const std::vector<std::list<Node>::iterator> &ends, std::list<Node>::iterator& oldEnd,
+    const std::vector<const Path*> &paths, const Path*& oldPath,
     const std::vector<MDD> &mdds, MDD& oldMDD,
     const std::vector<double> &lb, double& oldLb,
     int agentId, bool withMDD, bool withLb)
 {
     oldCost = costs[agentId];
-    oldStart = starts[agentId];
-    oldEnd = ends[agentId];
+    oldPath = paths[agentId];
     if (withMDD) {
         oldMDD = mdds[agentId];
     }
@@ -143,15 +397,13 @@ void ConflictBasedSearch<SearchType>::getState(
 template<typename SearchType>
 void ConflictBasedSearch<SearchType>::setState(
     std::vector<int> &costs, int oldCost,
-    std::vector<std::list<Node>::iterator> &starts, std::list<Node>::iterator oldStart,
-    std::vector<std::list<Node>::iterator> &ends, std::list<Node>::iterator oldEnd,
+    std::vector<const Path*> &paths, const Path* oldPath,
     std::vector<MDD> &mdds, const MDD& oldMDD,
     std::vector<double> &lb, double oldLb,
     int agentId, bool withMDD, bool withLb)
 {
     costs[agentId] = oldCost;
-    starts[agentId] = oldStart;
-    ends[agentId] = oldEnd;
+    paths[agentId] = oldPath;
     if (withMDD) {
         mdds[agentId] = oldMDD;
     }
@@ -164,11 +416,10 @@ template<typename SearchType>
 void ConflictBasedSearch<SearchType>::createNode(
     const Map &map, const AgentSet &agentSet, const Config &config,
     const Conflict &conflict, std::vector<int> &costs,
-    ConstraintsSet &constraints, int id1,
-    const Node &pos1, const Node &pos2,
-    std::vector<std::list<Node>::iterator> &starts,
-    std::vector<std::list<Node>::iterator> &ends,
-    ConflictAvoidanceTable &CAT, ConflictSet &conflictSet,
+    std::vector<ConstraintsList> &constraints, int id1,
+    const Constraint &constraint,
+    std::vector<const Path*> &paths,
+    ConflictAvoidanceTable &CAT, const PathTable &pathTable, ConflictSet &conflictSet,
     std::vector<MDD> &mdds, std::vector<double> &lb,
     std::vector<int> &LLExpansions, std::vector<int> &LLNodes,
     CBSNode<SearchType> *parentPtr,
@@ -177,47 +428,60 @@ void ConflictBasedSearch<SearchType>::createNode(
     std::chrono::steady_clock::time_point globalBegin,
     int globalTimeLimit)
 {
-    Constraint constraint(pos1.i, pos1.j, conflict.time, id1);
-    if (conflict.edgeConflict) {
-        constraint.prev_i = pos2.i;
-        constraint.prev_j = pos2.j;
-    }
-
-    ConstraintsSet agentConstraints = constraints.getAgentConstraints(id1);
+    // the agents of the meta-agent of id1 get new paths, id1 is the only agent in it if there are no merges
+    const std::vector<int> &agents = metaAgents[metaAgentIds[id1]];
+    ConstraintsSet agentConstraints;
+    agentConstraints.addConstraints(constraints[id1]);
     agentConstraints.addConstraint(constraint);
 
     Agent agent = agentSet.getAgent(id1);
     if (config.withCAT || config.withFocalSearch) {
-        CAT.removeAgentPath(starts[id1], ends[id1]);
+        for (int agentId : agents) {
+            CAT.removeAgentPath(*paths[agentId]);
+        }
     }
 
-    int oldCost;
-    std::list<Node>::iterator oldStart;
-    std::list<Node>::iterator oldEnd;
-    MDD oldMDD;
-    double oldLb;
+    std::vector<int> oldCosts(agents.size());
+    std::vector<const Path*> oldPaths(agents.size());
+    std::vector<MDD> oldMDDs(agents.size());
+    std::vector<double> oldLbs(agents.size());
     if (!updateNode) {
-        getState(costs, oldCost, starts, oldStart, ends, oldEnd, mdds, oldMDD, lb, oldLb,
-            id1, config.withCardinalConflicts, config.withFocalSearch);
+        for (int k = 0; k < int(agents.size()); ++k) {
+            getState(costs, oldCosts[k], paths, oldPaths[k], mdds, oldMDDs[k], lb, oldLbs[k],
+                agents[k], config.withCardinalConflicts, config.withFocalSearch);
+        }
 
         search->processConstraint(constraint, map, agent.getStart_i(), agent.getStart_j(),
             agent.getGoal_i(), agent.getGoal_j(), id1,
             {}, agentConstraints, config.withCAT, CAT);
     }
 
-    std::list<Node> newPath = getNewPath(map, agentSet, agent, constraint, agentConstraints,
-        starts[id1], ends[id1], config.withCAT, CAT, lb, LLExpansions, LLNodes, search,
-        (!updateNode && !config.withReplanning) || forceRestart, globalBegin, globalTimeLimit);
+    std::vector<Path> newPaths;
+    if (agents.size() == 1) {
+        Path newPath = getNewPath(map, agentSet, agent, constraint, agentConstraints,
+            *paths[id1], config.withCAT, CAT, lb, LLExpansions, LLNodes, search,
+            (!updateNode && !config.withReplanning) || forceRestart, globalBegin, globalTimeLimit);
+        if (!newPath.empty()) {
+            newPaths.push_back(std::move(newPath));
+        }
+    } else {
+        ConstraintsList oldConstraints = constraints[id1];
+        constraints[id1] = addToConstraintsList(constraint, oldConstraints);
+        newPaths = getMetaAgentPaths(map, config, agentSet, agents, constraints, globalBegin, globalTimeLimit);
+        constraints[id1] = oldConstraints;
+    }
 
     if (config.withCAT || config.withFocalSearch) {
-        if (updateNode && !newPath.empty()) {
-            CAT.addAgentPath(newPath.begin(), newPath.end());
-        } else {
-            CAT.addAgentPath(starts[id1], ends[id1]);
+        for (int k = 0; k < int(agents.size()); ++k) {
+            if (updateNode && !newPaths.empty()) {
+                CAT.addAgentPath(newPaths[k]);
+            } else {
+                CAT.addAgentPath(*paths[agents[k]]);
+            }
         }
     }
 
-    if (newPath.empty()) {
+    if (newPaths.empty()) {
         node.pathFound = false;
         return;
     }
@@ -228,31 +492,49 @@ void ConflictBasedSearch<SearchType>::createNode(
         std::swap(node.conflict.pos1, node.conflict.pos2);
     }
 
-    node.paths[id1] = newPath;
-    node.cost = 0;
-    for (int i = 0; i < costs.size(); ++i) {
-        if (i == id1) {
-            node.cost += newPath.size() - 1;
-            costs[i] = newPath.size() - 1;
-        } else {
-            node.cost += costs[i];
-        }
+    for (int k = 0; k < int(agents.size()); ++k) {
+        costs[agents[k]] = newPaths[k].getCost();
+        node.paths[agents[k]] = std::move(newPaths[k]);
     }
+    node.cost = std::accumulate(costs.begin(), costs.end(), 0);
     node.constraint = constraint;
+    node.constraints[id1] = addToConstraintsList(constraint, constraints[id1]);
     node.parent = parentPtr;
+    node.depth = parentPtr->depth + 1;
 
     if (config.withCardinalConflicts) {
-        node.mdds[id1] = MDD(map, agentSet, search, id1, newPath.size() - 1, agentConstraints);
-        mdds[id1] = node.mdds[id1];
+        for (int agentId : agents) {
+            // the MDD of the parent has all constraints but the new one, so it is pruned if the cost is the same
+            int pathCost = costs[agentId];
+            const ConstraintsList &agentList = agentId == id1 ? node.constraints[id1] : constraints[agentId];
+            MDD &mdd = mddCache.get(agentId, pathCost, agentList);
+            if (mdd.empty()) {
+                if (mdds[agentId].getCost() == pathCost) {
+                    mdd = agentId == id1 ? MDD(mdds[agentId], constraint) : mdds[agentId];
+                } else if (agentId == id1) {
+                    mdd = MDD(map, agentSet, agentId, pathCost, agentConstraints);
+                } else {
+                    ConstraintsSet otherConstraints;
+                    otherConstraints.addConstraints(agentList);
+                    mdd = MDD(map, agentSet, agentId, pathCost, otherConstraints);
+                }
+            }
+            node.mdds[agentId] = mdd;
+            mdds[agentId] = mdd;
+        }
     }
 
-    starts[id1] = node.paths[id1].begin();
-    ends[id1] = node.paths[id1].end();
+    for (int agentId : agents) {
+        paths[agentId] = &node.paths[agentId];
+    }
     if (config.storeConflicts) {
-        ConflictSet agentConflicts = findConflict<std::list<Node>::iterator>(starts, ends, id1, true,
-                                                                             config.withCardinalConflicts, mdds);
+        // the table has the old paths of the other agents of a meta-agent, so they are compared without it
         node.conflictSet = conflictSet;
-        node.conflictSet.replaceAgentConflicts(id1, agentConflicts);
+        for (int agentId : agents) {
+            ConflictSet agentConflicts = findConflict(paths, agentId, true, config.withCardinalConflicts, mdds,
+                                                      agents.size() == 1 ? &pathTable : nullptr);
+            node.conflictSet.replaceAgentConflicts(agentId, agentConflicts);
+        }
     }
     if (config.withFocalSearch) {
         node.hc = node.conflictSet.getConflictingPairsCount();
@@ -263,16 +545,243 @@ void ConflictBasedSearch<SearchType>::createNode(
         node.lb[id1] = lb[id1];
     }
 
+    // the costs of the agents of a meta-agent are not bounded one by one, so their conflicts are left out
+    ConflictSet heuristicConflicts;
+    ConflictSet &agentConflicts = config.mergeThreshold == -1 ? node.conflictSet : heuristicConflicts;
+    if (config.mergeThreshold != -1 && (config.withMatchingHeuristic || config.withDGHeuristic ||
+                                        config.withWDGHeuristic)) {
+        heuristicConflicts = node.conflictSet;
+        for (int agentId = 0; agentId < int(metaAgentIds.size()); ++agentId) {
+            if (isMerged(agentId)) {
+                heuristicConflicts.removeAgentConflicts(agentId);
+            }
+        }
+    }
     if (config.withMatchingHeuristic) {
-        node.H = node.conflictSet.getMatchingHeuristic();
+        node.H = agentConflicts.getMatchingHeuristic();
+    } else if (config.withDGHeuristic || config.withWDGHeuristic) {
+        ConstraintsList oldConstraints = constraints[id1];
+        constraints[id1] = node.constraints[id1];
+        node.H = wdgHeuristic.getHeuristic(map, agentSet, agentConflicts, costs, mdds, constraints,
+                                           mddCache, config.withWDGHeuristic);
+        constraints[id1] = oldConstraints;
     }
 
     if (!updateNode) {
-        setState(costs, oldCost, starts, oldStart, ends, oldEnd, mdds, oldMDD, lb, oldLb,
-            id1, config.withCardinalConflicts, config.withFocalSearch);
+        for (int k = 0; k < int(agents.size()); ++k) {
+            setState(costs, oldCosts[k], paths, oldPaths[k], mdds, oldMDDs[k], lb, oldLbs[k],
+                agents[k], config.withCardinalConflicts, config.withFocalSearch);
+        }
     }
 
     node.G = node.H + node.cost;
+    if (config.withExplicitEstimation) {
+        node.G = getEstimatedCost(node);
+    }
+}
+
+template<typename SearchType>
+bool ConflictBasedSearch<SearchType>::createRoot(const Map &map, const Config &config, const AgentSet &agentSet,
+    const std::vector<ConstraintsList> &rootConstraints,
+    std::chrono::steady_clock::time_point begin,
+    std::chrono::steady_clock::time_point globalBegin,
+    int globalTimeLimit)
+{
+    int agentCount = agentSet.getAgentCount();
+    if (int(metaAgentIds.size()) != agentCount) {
+        metaAgents.resize(agentCount);
+        metaAgentIds.resize(agentCount);
+        for (int i = 0; i < agentCount; ++i) {
+            metaAgents[i] = {i};
+            metaAgentIds[i] = i;
+        }
+    }
+
+    nodes.emplace_back();
+    CBSNode<SearchType> &root = nodes.back();
+    std::vector<const Path*> paths(agentCount);
+    std::vector<MDD> mdds(agentCount);
+    ConflictAvoidanceTable CAT;
+    for (int i = 0; i < agentSet.getAgentCount(); ++i) {
+        //std::cout << i << std::endl;
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - begin).count() > config.maxTime) {
+            return false;
+        }
+
+        if (globalTimeLimit != -1 &&
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - globalBegin).count() > config.maxTime)
+        {
+            return false;
+        }
+
+        ConstraintsSet agentConstraints;
+        bool hasRootConstraints = !rootConstraints.empty() && rootConstraints[i] != nullptr;
+        if (hasRootConstraints) {
+            root.constraints[i] = rootConstraints[i];
+            agentConstraints.addConstraints(rootConstraints[i]);
+        }
+
+        const std::vector<int> &metaAgent = metaAgents[metaAgentIds[i]];
+        if (metaAgent.size() > 1) {
+            // agents of a meta-agent are sorted, they are planned together at the first of them
+            if (metaAgent[0] == i) {
+                std::vector<Path> metaAgentPaths = getMetaAgentPaths(map, config, agentSet, metaAgent,
+                    rootConstraints.empty() ? std::vector<ConstraintsList>(agentCount) : rootConstraints,
+                    globalBegin, globalTimeLimit);
+                if (metaAgentPaths.empty()) {
+                    return false;
+                }
+                for (int k = 0; k < int(metaAgent.size()); ++k) {
+                    root.paths[metaAgent[k]] = std::move(metaAgentPaths[k]);
+                }
+            }
+            int cost = root.paths[i].getCost();
+            root.cost += cost;
+            if (config.withCardinalConflicts) {
+                root.mdds[i] = MDD(map, agentSet, i, cost, agentConstraints);
+            }
+            paths[i] = &root.paths[i];
+            mdds[i] = root.mdds[i];
+            continue;
+        }
+
+        Astar<> astar(false, false);
+        Agent agent = agentSet.getAgent(i);
+        SearchResult searchResult;
+
+        if (config.withCAT && config.useCatAtRoot) {
+            SearchType* searchPtr = search;
+            searchResult = searchPtr->startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
+                                               agent.getGoal_i(), agent.getGoal_j(), nullptr,
+                                               true, true, 0, -1, -1, {}, agentConstraints, true, CAT,
+                                               globalBegin, globalTimeLimit);
+            if (searchResult.pathfound) {
+                CAT.addAgentPath(Path(searchResult.lppath->begin(), searchResult.lppath->end()));
+            }
+        } else {
+            if (config.withReplanning) {
+                SearchType tempSearch = *search;
+                rootSearches.push_back(std::move(tempSearch));
+                searchResult = rootSearches.back().startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
+                    agent.getGoal_i(), agent.getGoal_j(),
+                    nullptr, true, true, 0, -1, -1, {}, agentConstraints, false, {}, globalBegin, globalTimeLimit);
+            } else if (hasRootConstraints) {
+                // the constraints can make the agent wait, which the search without time can not do
+                searchResult = search->startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
+                    agent.getGoal_i(), agent.getGoal_j(),
+                    nullptr, true, true, 0, -1, -1, {}, agentConstraints, false, {}, globalBegin, globalTimeLimit);
+            } else {
+                astar.setPerfectHeuristic(&perfectHeuristic);
+                searchResult = astar.startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
+                    agent.getGoal_i(), agent.getGoal_j(),
+                    nullptr, true, true, 0, -1, -1, {}, agentConstraints, false, {}, globalBegin, globalTimeLimit);
+            }
+        }
+        if (!searchResult.pathfound) {
+            //std::cout << "fail" << std::endl;
+            return false;
+        }
+        root.cost += searchResult.pathlength;
+        root.paths[i] = Path(searchResult.lppath->begin(), searchResult.lppath->end());
+
+        if (config.withCardinalConflicts) {
+            root.mdds[i] = MDD(map, agentSet, i, searchResult.pathlength, agentConstraints);
+        }
+
+        paths[i] = &root.paths[i];
+        mdds[i] = root.mdds[i];
+        if (config.withFocalSearch) {
+            root.lb[i] = searchResult.minF;
+            root.sumLb += searchResult.minF;
+        }
+    }
+
+    if (config.storeConflicts) {
+        root.conflictSet = findConflict(paths, -1, true, config.withCardinalConflicts, mdds);
+        if (config.withFocalSearch) {
+            root.hc = root.conflictSet.getConflictingPairsCount();
+            sumLb.insert(&root);
+        }
+    }
+
+    root.G = root.cost;
+    open.insert(&root);
+    return true;
+}
+
+template<typename SearchType>
+std::vector<Path> ConflictBasedSearch<SearchType>::getMetaAgentPaths(const Map &map, const Config &config,
+    const AgentSet &agentSet, const std::vector<int> &agents,
+    const std::vector<ConstraintsList> &constraints,
+    std::chrono::steady_clock::time_point globalBegin,
+    int globalTimeLimit)
+{
+    // the agents are solved by CBS on their own, with their constraints renumbered to their local ids
+    AgentSet metaAgentSet;
+    std::vector<ConstraintsList> metaAgentConstraints(agents.size());
+    for (int k = 0; k < int(agents.size()); ++k) {
+        Agent agent = agentSet.getAgent(agents[k]);
+        metaAgentSet.addAgent(agent.getStart_i(), agent.getStart_j(), agent.getGoal_i(), agent.getGoal_j());
+
+        std::vector<Constraint> agentConstraints;
+        for (ConstraintsList it = constraints[agents[k]]; it != nullptr; it = it->next) {
+            agentConstraints.push_back(it->constraint);
+        }
+        for (auto it = agentConstraints.rbegin(); it != agentConstraints.rend(); ++it) {
+            it->agentId = k;
+            metaAgentConstraints[k] = addToConstraintsList(*it, metaAgentConstraints[k]);
+        }
+    }
+
+    Config metaAgentConfig = config;
+    metaAgentConfig.LogParams = nullptr;
+    metaAgentConfig.SearchParams = nullptr;
+    metaAgentConfig.mergeThreshold = -1;
+    metaAgentConfig.withPerfectHeuristic = false;
+
+    ConflictBasedSearch<SearchType> metaAgentSearch(search);
+    MultiagentSearchResult result = metaAgentSearch.findSolution(map, metaAgentConfig, metaAgentSet,
+        metaAgentConstraints, globalBegin, globalTimeLimit);
+    metaAgentSearch.search = nullptr;
+
+    std::vector<Path> res;
+    if (result.pathfound) {
+        for (auto &agentPath : metaAgentSearch.agentsPaths) {
+            res.emplace_back(agentPath.begin(), agentPath.end());
+        }
+    }
+    return res;
+}
+
+template<typename SearchType>
+int ConflictBasedSearch<SearchType>::getEstimatedCost(const CBSNode<SearchType> &node) const {
+    // every expansion on average changes the cost by the cost error and removes 1 - conflicts error conflicts
+    if (errorsCount == 0 || node.hc == 0) {
+        return node.G;
+    }
+    // an expansion that on average removes no conflicts would make the estimate infinite for every node,
+    // so the error is kept below 1 and the nodes are still ordered by their conflicts
+    double conflictsError = std::min(conflictsErrorSum / errorsCount, 0.99);
+    double costError = std::max(costErrorSum / errorsCount, 0.0);
+    return node.G + int(std::lround(node.hc * costError / (1 - conflictsError)));
+}
+
+template<typename SearchType>
+int ConflictBasedSearch<SearchType>::getBranchConflictsCount(const CBSNode<SearchType> *node,
+                                                             const Conflict &conflict) const {
+    auto getMetaAgentPair = [this](const Conflict &conflict) -> std::pair<int, int> {
+        return std::minmax(metaAgentIds[conflict.id1], metaAgentIds[conflict.id2]);
+    };
+    std::pair<int, int> metaAgentPair = getMetaAgentPair(conflict);
+    int res = 1;
+    for (; node->parent != nullptr; node = node->parent) {
+        if (getMetaAgentPair(node->conflict) == metaAgentPair) {
+            ++res;
+        }
+    }
+    return res;
 }
 
 template<typename SearchType>
@@ -282,17 +791,25 @@ MultiagentSearchResult ConflictBasedSearch<SearchType>::startSearch(const Map &m
     int globalTimeLimit)
 {
     std::cout << agentSet.getAgentCount() << std::endl;
+    return findSolution(map, config, agentSet, {}, globalBegin, globalTimeLimit);
+}
 
+template<typename SearchType>
+MultiagentSearchResult ConflictBasedSearch<SearchType>::findSolution(const Map &map,
+    const Config &config, const AgentSet &agentSet,
+    const std::vector<ConstraintsList> &rootConstraints,
+    std::chrono::steady_clock::time_point globalBegin,
+    int globalTimeLimit)
+{
     //ISearch<>::T = 0;
 
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
     if (config.withPerfectHeuristic) {
-        getPerfectHeuristic(map, agentSet);
+        getPerfectHeuristic(map, agentSet, config.heuristicCache);
         search->setPerfectHeuristic(&perfectHeuristic);
     }
 
-    CBSNode<SearchType> root;
     int agentCount = agentSet.getAgentCount();
     MultiagentSearchResult result(false);
     result.HLNodesStart = {double(open.size() + close.size() + focal.size())};
@@ -300,94 +817,104 @@ MultiagentSearchResult ConflictBasedSearch<SearchType>::startSearch(const Map &m
     result.HLNodes = result.HLNodesStart;
     result.HLExpansions = result.HLExpansionsStart;
 
-    if (open.empty() && focal.empty()) {
-        std::vector<std::list<Node>::iterator> starts(agentCount), ends(agentCount);
-        std::vector<MDD> mdds;
-        ConflictAvoidanceTable CAT;
-        for (int i = 0; i < agentSet.getAgentCount(); ++i) {
-            //std::cout << i << std::endl;
-
-            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(now - begin).count() > config.maxTime) {
-                result.pathfound = false;
-                return result;
-            }
-
-            if (globalTimeLimit != -1 &&
-                std::chrono::duration_cast<std::chrono::milliseconds>(now - globalBegin).count() > config.maxTime)
-            {
-                result.pathfound = false;
-                return result;
-            }
+    if (open.empty() && focal.empty() &&
+            !createRoot(map, config, agentSet, rootConstraints, begin, globalBegin, globalTimeLimit)) {
+        result.pathfound = false;
+        return result;
+    }
 
-            Astar<> astar(false, false);
-            Agent agent = agentSet.getAgent(i);
-            SearchResult searchResult;
+    std::vector<int> LLExpansions, LLNodes;
 
-            if (config.withCAT && config.useCatAtRoot) {
-                SearchType* searchPtr = search;
-                searchResult = searchPtr->startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
-                                                   agent.getGoal_i(), agent.getGoal_j(), nullptr,
-                                                   true, true, 0, -1, -1, {}, {}, true, CAT, globalBegin, globalTimeLimit);
-                if (searchResult.pathfound) {
-                    CAT.addAgentPath(searchResult.lppath->begin(), searchResult.lppath->end());
-                }
-            } else {
-                if (config.withReplanning) {
-                    SearchType tempSearch = *search;
-                    rootSearches.push_back(std::move(tempSearch));
-                    searchResult = rootSearches.back().startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
-                        agent.getGoal_i(), agent.getGoal_j(),
-                        nullptr, true, true, 0, -1, -1, {}, {}, false, {}, globalBegin, globalTimeLimit);
-                } else {
-                    astar.setPerfectHeuristic(&perfectHeuristic);
-                    searchResult = astar.startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
-                        agent.getGoal_i(), agent.getGoal_j(),
-                        nullptr, true, true, 0, -1, -1, {}, {}, false, {}, globalBegin, globalTimeLimit);
-                }
-            }
-            if (!searchResult.pathfound) {
-                //std::cout << "fail" << std::endl;
-                result.pathfound = false;
-                return result;
-            }
-            root.cost += searchResult.pathlength;
-            root.paths[i] = *searchResult.lppath;
+    // State of the last expanded CT node (stateNode): paths, costs, MDDs, lower bounds and constraints of all agents
+    // and CAT of their paths. Each node changes it only for the agents in its paths and constraints,
+    // so it is moved between nodes by undoing and redoing these changes.
+    std::vector<int> costs(agentCount, 0);
+    std::vector<const Path*> paths(agentCount);
+    std::vector<ConstraintsList> constraints(agentCount);
+    ConflictAvoidanceTable CAT;
+    PathTable pathTable = config.storeConflicts ? PathTable(map.getMapHeight(), map.getMapWidth()) : PathTable();
+    std::vector<MDD> mdds(agentCount);
+    std::vector<double> lb(agentCount);
+    std::vector<int> agentsReplanningCount(agentCount, 0);
+    std::vector<CBSNode<SearchType>*> pathNodes(agentCount, nullptr);
+    CBSNode<SearchType> *stateNode = nullptr;
+    // nodes of the trees dropped when agents are merged
+    int droppedExpansions = 0, droppedNodes = 0;
+    // the bound on the estimated cost of the nodes in FOCAL in EECBS, it follows the best estimated cost of OPEN
+    double focalBound = -1;
 
-            if (config.withCardinalConflicts) {
-                root.mdds[i] = MDD(map, agentSet, search, i, searchResult.pathlength);
-            }
-
-            starts[i] = root.paths[i].begin();
-            ends[i] = root.paths[i].end();
-            mdds.push_back(root.mdds[i]);
-            if (config.withFocalSearch) {
-                root.lb[i] = searchResult.minF;
-                root.sumLb += searchResult.minF;
+    auto setAgentPath = [&](int agentId, CBSNode<SearchType> *owner, bool replace) {
+        const Path &path = owner->paths.find(agentId)->second;
+        if (config.withCAT || config.withFocalSearch) {
+            if (replace) {
+                CAT.removeAgentPath(*paths[agentId]);
             }
+            CAT.addAgentPath(path);
         }
-
         if (config.storeConflicts) {
-            root.conflictSet = findConflict<std::list<Node>::iterator>(starts, ends, -1, true,
-                                                                       config.withCardinalConflicts, mdds);
-            if (config.withFocalSearch) {
-                root.hc = root.conflictSet.getConflictingPairsCount();
-                sumLb.insert(root.sumLb);
+            if (replace) {
+                pathTable.removeAgentPath(*paths[agentId], agentId);
             }
+            pathTable.addAgentPath(path, agentId);
         }
+        paths[agentId] = &path;
+        costs[agentId] = path.getCost();
+        pathNodes[agentId] = owner;
+        if (config.withCardinalConflicts) {
+            mdds[agentId] = owner->mdds.find(agentId)->second;
+        }
+        if (config.withFocalSearch) {
+            lb[agentId] = owner->lb[agentId];
+        }
+    };
+    auto redoNode = [&](CBSNode<SearchType> *node) {
+        for (auto it = node->paths.begin(); it != node->paths.end(); ++it) {
+            setAgentPath(it->first, node, node->parent != nullptr);
+            ++agentsReplanningCount[it->first];
+        }
+        for (auto it = node->constraints.begin(); it != node->constraints.end(); ++it) {
+            constraints[it->first] = it->second;
+        }
+    };
+    auto undoNode = [&](CBSNode<SearchType> *node) {
+        for (auto it = node->paths.begin(); it != node->paths.end(); ++it) {
+            setAgentPath(it->first, node->prevPathNodes[it->first], true);
+            --agentsReplanningCount[it->first];
+        }
+        for (auto it = node->constraints.begin(); it != node->constraints.end(); ++it) {
+            constraints[it->first] = it->second->next;
+        }
+    };
+    auto getAgentSearch = [&](int agentId) {
+        for (CBSNode<SearchType> *ptr = close.back(); ptr->parent != nullptr; ptr = ptr->parent) {
+            if (ptr->paths.begin()->first == agentId) {
+                return ptr->search.get();
+            }
+        }
+        return &rootSearches[agentId];
+    };
 
-        open.insert(root);
-    }
-
-    std::vector<int> LLExpansions, LLNodes;
+    // nodes of FOCAL are in OPEN too in EECBS
+    auto getNodesCount = [&]() {
+        return double(droppedNodes + open.size() + close.size() + (config.withExplicitEstimation ? 0 : focal.size()));
+    };
+    auto insertNode = [&](CBSNode<SearchType> *node) {
+        open.insert(node);
+        if (config.withFocalSearch) {
+            sumLb.insert(node);
+        }
+        if (config.withExplicitEstimation && node->G <= focalBound) {
+            focal.insert(node);
+        }
+    };
 
     int t = 0;
     while (!open.empty() || !focal.empty()) {
         ++t;
         std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
         if (std::chrono::duration_cast<std::chrono::milliseconds>(now - begin).count() > config.maxTime) {
-            result.HLExpansions = {double(close.size())};
-            result.HLNodes = {double(open.size() + close.size() + focal.size())};
+            result.HLExpansions = {double(droppedExpansions + close.size())};
+            result.HLNodes = {getNodesCount()};
             result.pathfound = false;
             break;
         }
@@ -395,17 +922,45 @@ MultiagentSearchResult ConflictBasedSearch<SearchType>::startSearch(const Map &m
         if (globalTimeLimit != -1 &&
             std::chrono::duration_cast<std::chrono::milliseconds>(now - globalBegin).count() > config.maxTime)
         {
-            result.HLExpansions = {double(close.size())};
-            result.HLNodes = {double(open.size() + close.size() + focal.size())};
+            result.HLExpansions = {double(droppedExpansions + close.size())};
+            result.HLNodes = {getNodesCount()};
             result.pathfound = false;
             return result;
         }
 
-        CBSNode<SearchType> cur;
-        if (config.withFocalSearch) {
-            double threshold = *sumLb.begin() * config.focalW;
+        CBSNode<SearchType> *cur;
+        if (config.withExplicitEstimation) {
+            // FOCAL has the nodes of OPEN within focalW of the best estimated cost. A node is expanded by conflicts
+            // or by the estimate only if its cost is within focalW of the lower bound, otherwise the node with
+            // the lowest bound is expanded to raise it, so the solution stays w-suboptimal
+            double threshold = (*sumLb.begin())->sumLb * config.focalW;
+            double newFocalBound = (*open.begin())->G * config.focalW;
+            if (newFocalBound > focalBound) {
+                for (auto it = open.begin(); it != open.end() && (*it)->G <= newFocalBound; ++it) {
+                    if ((*it)->G > focalBound) {
+                        focal.insert(*it);
+                    }
+                }
+            } else if (newFocalBound < focalBound) {
+                // the best estimate has dropped, so the nodes above the new bound leave FOCAL
+                for (auto it = open.begin(); it != open.end() && (*it)->G <= focalBound; ++it) {
+                    if ((*it)->G > newFocalBound) {
+                        focal.erase(*it);
+                    }
+                }
+            }
+            focalBound = newFocalBound;
+            if (!focal.empty() && (*focal.begin())->cost <= threshold) {
+                cur = *focal.begin();
+            } else if ((*open.begin())->cost <= threshold) {
+                cur = *open.begin();
+            } else {
+                cur = *sumLb.begin();
+            }
+        } else if (config.withFocalSearch) {
+            double threshold = (*sumLb.begin())->sumLb * config.focalW;
             auto it = open.begin();
-            for (it; it != open.end() && it->cost <= threshold && (it->cost <= bestKnownCost || focal.empty()); ++it) {
+            for (it; it != open.end() && (*it)->cost <= threshold && ((*it)->cost <= bestKnownCost || focal.empty()); ++it) {
                 focal.insert(*it);
             }
             open.erase(open.begin(), it);
@@ -414,71 +969,45 @@ MultiagentSearchResult ConflictBasedSearch<SearchType>::startSearch(const Map &m
             cur = *open.begin();
         }
 
-        std::vector<int> costs(agentCount, 0);
-        std::vector<bool> agentFound(agentCount, false);
-        std::vector<std::list<Node>::iterator> starts(agentCount), ends(agentCount);
-        ConstraintsSet constraints;
-        ConflictAvoidanceTable CAT;
-        std::vector<MDD> mdds(agentCount);
-        std::vector<double> lb(agentCount);
-        std::vector<SearchType*> agentSearches(agentCount, nullptr);
-        std::vector<int> agentsReplanningCount(agentCount, 0);
-        for (CBSNode<SearchType> *ptr = &cur; ptr != nullptr; ptr = ptr->parent) {
-            for (auto it = ptr->paths.begin(); it != ptr->paths.end(); ++it) {
-                if (!agentFound[it->first]) {
-                    starts[it->first] = it->second.begin();
-                    ends[it->first] = it->second.end();
-                    costs[it->first] = it->second.size() - 1;
-                    agentFound[it->first] = true;
-
-                    if (config.withCAT || config.withFocalSearch) {
-                        CAT.addAgentPath(starts[it->first], ends[it->first]);
-                    }
-                    if (config.withCardinalConflicts) {
-                        mdds[it->first] = ptr->mdds.find(it->first)->second;
-                    }
-                    if (config.withFocalSearch) {
-                        lb[it->first] = ptr->lb[it->first];
-                    }
-                }
-                agentsReplanningCount[it->first]++;
+        // move the state from the last expanded node to the parent of cur through their common ancestor
+        std::vector<CBSNode<SearchType>*> redoNodes;
+        CBSNode<SearchType> *from = stateNode, *to = cur->parent;
+        if (from == nullptr) {
+            for (; to != nullptr; to = to->parent) {
+                redoNodes.push_back(to);
             }
-            if (ptr->parent == nullptr && config.withReplanning) {
-                for (int agentId = 0; agentId < agentSearches.size(); ++agentId) {
-                    if (agentSearches[agentId] == nullptr) {
-                        agentSearches[agentId] = &rootSearches[agentId];
-                    }
-                }
+        }
+        while (from != to) {
+            if (from->depth >= to->depth) {
+                undoNode(from);
+                from = from->parent;
             } else {
-                int agentId = ptr->paths.begin()->first;
-                constraints.addConstraint(ptr->constraint);
-                if (ptr->hasPositiveConstraint) {
-                    constraints.addConstraint(ptr->positiveConstraint);
-                }
-                if (config.withReplanning && agentSearches[agentId] == nullptr) {
-                    agentSearches[agentId] = ptr->search.get();
-                }
+                redoNodes.push_back(to);
+                to = to->parent;
             }
         }
+        for (auto it = redoNodes.rbegin(); it != redoNodes.rend(); ++it) {
+            redoNode(*it);
+        }
+        redoNode(cur);
 
         ConflictSet conflictSet;
         if (!config.storeConflicts) {
-            conflictSet = findConflict<std::list<Node>::iterator>(starts, ends, -1, false,
-                                                                  config.withCardinalConflicts, mdds);
+            conflictSet = findConflict(paths, -1, false, config.withCardinalConflicts, mdds);
         } else {
-            conflictSet = cur.conflictSet;
+            conflictSet = cur->conflictSet;
         }
         if (conflictSet.empty()) {
             agentsPaths.resize(agentCount);
             for (int i = 0; i < agentCount; ++i) {
-                for (auto it = starts[i]; it != ends[i]; ++it) {
-                    agentsPaths[i].push_back(*it);
+                for (int time = 0; time < paths[i]->size(); ++time) {
+                    agentsPaths[i].push_back(paths[i]->getNode(time));
                 }
             }
             result.agentsPaths = &agentsPaths;
             result.pathfound = true;
-            result.HLExpansions = {double(close.size())};
-            result.HLNodes = {double(open.size() + close.size() + focal.size())};
+            result.HLExpansions = {double(droppedExpansions + close.size())};
+            result.HLNodes = {getNodesCount()};
             if (LLExpansions.empty()) {
                 result.AvgLLExpansions = {0};
                 result.AvgLLNodes = {0};
@@ -489,7 +1018,7 @@ MultiagentSearchResult ConflictBasedSearch<SearchType>::startSearch(const Map &m
 
             result.totalNodes = {0};
 
-            result.cost = {cur.cost};
+            result.cost = {cur->cost};
             result.focalW = {config.focalW};
 
             std::pair<int, int> costs = result.getCosts();
@@ -503,84 +1032,158 @@ MultiagentSearchResult ConflictBasedSearch<SearchType>::startSearch(const Map &m
             break;
         }
 
-        if (config.withFocalSearch) {
+        if (config.withExplicitEstimation) {
+            open.erase(cur);
+            focal.erase(cur);
+            sumLb.erase(cur);
+        } else if (config.withFocalSearch) {
             focal.erase(cur);
-            sumLb.erase(sumLb.find(cur.sumLb));
+            sumLb.erase(cur);
         } else {
             open.erase(cur);
         }
         close.push_back(cur);
+        stateNode = cur;
 
         Conflict conflict = conflictSet.getBestConflict();
-        if (config.withDisjointSplitting &&
+        if (config.mergeThreshold != -1 && getBranchConflictsCount(cur, conflict) > config.mergeThreshold) {
+            // the agents are merged into one meta-agent and the search restarts from a new root
+            std::vector<int> &metaAgent1 = metaAgents[metaAgentIds[conflict.id1]];
+            std::vector<int> &metaAgent2 = metaAgents[metaAgentIds[conflict.id2]];
+            for (int agentId : metaAgent2) {
+                metaAgentIds[agentId] = metaAgentIds[conflict.id1];
+            }
+            metaAgent1.insert(metaAgent1.end(), metaAgent2.begin(), metaAgent2.end());
+            std::sort(metaAgent1.begin(), metaAgent1.end());
+            metaAgent2.clear();
+
+            droppedExpansions += close.size();
+            droppedNodes += open.size() + close.size();
+            open.clear();
+            close.clear();
+            nodes.clear();
+            rootSearches.clear();
+            costs.assign(agentCount, 0);
+            constraints.assign(agentCount, nullptr);
+            CAT = ConflictAvoidanceTable();
+            if (config.storeConflicts) {
+                pathTable = PathTable(map.getMapHeight(), map.getMapWidth());
+            }
+            mdds.assign(agentCount, MDD());
+            agentsReplanningCount.assign(agentCount, 0);
+            pathNodes.assign(agentCount, nullptr);
+            stateNode = nullptr;
+            if (!createRoot(map, config, agentSet, rootConstraints, begin, globalBegin, globalTimeLimit)) {
+                result.HLExpansions = {double(droppedExpansions)};
+                result.HLNodes = {double(droppedNodes)};
+                result.pathfound = false;
+                break;
+            }
+            continue;
+        }
+
+        // disjoint splitting is used only between single agents, meta-agents get no positive constraints
+        if (config.withDisjointSplitting && !isMerged(conflict.id1) && !isMerged(conflict.id2) &&
                 mdds[conflict.id1].getLayerSize(conflict.time) < mdds[conflict.id2].getLayerSize(conflict.time)) {
             std::swap(conflict.id1, conflict.id2);
             std::swap(conflict.pos1, conflict.pos2);
         }
 
-        close.back().newConflict = conflict;
+        Constraint constraint1, constraint2;
+        bool symmetric = getConstraints(map, config, conflictSet, paths, mdds, constraints,
+                                        conflict, constraint1, constraint2);
+        cur->newConflict = conflict;
 
-        CBSNode<SearchType> child1, child2;
+        // children are created in place in the pool, a child without a path is removed right away
+        std::vector<CBSNode<SearchType>*> children;
+        nodes.emplace_back();
+        CBSNode<SearchType> *child1 = &nodes.back();
+        for (int agentId : metaAgents[metaAgentIds[conflict.id1]]) {
+            child1->prevPathNodes[agentId] = pathNodes[agentId];
+        }
         if (config.withReplanning) {
-            child1.search.reset(new SearchType(*agentSearches[conflict.id1]));
-            child2.search.reset(new SearchType(*agentSearches[conflict.id2]));
+            child1->search.reset(new SearchType(*getAgentSearch(conflict.id1)));
         }
-
-        std::vector<CBSNode<SearchType>> children;
         createNode(map, agentSet, config, conflict, costs, constraints,
-            conflict.id1, conflict.pos2, conflict.pos1, starts, ends,
-            CAT, conflictSet, mdds, lb, LLExpansions, LLNodes, &close.back(), child1,
-            config.withReplanning ? child1.search.get() : search,
+            conflict.id1, constraint1, paths,
+            CAT, pathTable, conflictSet, mdds, lb, LLExpansions, LLNodes, cur, *child1,
+            config.withReplanning ? child1->search.get() : search,
             false, agentsReplanningCount[conflict.id1] % config.lowLevelRestartFrequency == 0,
             globalBegin, globalTimeLimit);
-        if (child1.pathFound) {
+        if (child1->pathFound) {
             children.push_back(child1);
+        } else {
+            nodes.pop_back();
+        }
+
+        nodes.emplace_back();
+        CBSNode<SearchType> *child2 = &nodes.back();
+        for (int agentId : metaAgents[metaAgentIds[conflict.id2]]) {
+            child2->prevPathNodes[agentId] = pathNodes[agentId];
+        }
+        if (config.withReplanning) {
+            child2->search.reset(new SearchType(*getAgentSearch(conflict.id2)));
         }
         createNode(map, agentSet, config, conflict, costs, constraints,
-            conflict.id2, conflict.pos1, conflict.pos2, starts, ends,
-            CAT, conflictSet, mdds, lb, LLExpansions, LLNodes, &close.back(), child2,
-            config.withReplanning ? child2.search.get() : search,
+            conflict.id2, constraint2, paths,
+            CAT, pathTable, conflictSet, mdds, lb, LLExpansions, LLNodes, cur, *child2,
+            config.withReplanning ? child2->search.get() : search,
             false, agentsReplanningCount[conflict.id1] % config.lowLevelRestartFrequency == 0,
             globalBegin, globalTimeLimit);
-        if (child2.pathFound) {
+        if (child2->pathFound) {
+            if (constraint1.length == 1) {
+                // the path of agent 1 already ends in time, the constraint keeps it so in the subtree
+                Constraint lengthConstraint = constraint1;
+                lengthConstraint.length = -1;
+                child2->constraints[conflict.id1] = addToConstraintsList(lengthConstraint, constraints[conflict.id1]);
+            }
             children.push_back(child2);
+        } else {
+            nodes.pop_back();
+        }
+
+        if (config.withExplicitEstimation && !children.empty()) {
+            // the errors of the cost and of the number of conflicts per expansion are learned on the best child
+            CBSNode<SearchType> *best = *std::min_element(children.begin(), children.end(),
+                [](const CBSNode<SearchType> *lhs, const CBSNode<SearchType> *rhs) {
+                    return lhs->hc < rhs->hc || (lhs->hc == rhs->hc && lhs->cost < rhs->cost);
+                });
+            costErrorSum += best->cost + best->H - cur->cost - cur->H;
+            conflictsErrorSum += best->hc - cur->hc + 1;
+            ++errorsCount;
         }
 
         bool bypass = false;
         if (children.size() == 2) {
-            for (auto& child : children) {
-                if (child.pathFound && config.withBypassing && cur.cost == child.cost &&
-                        conflictSet.getConflictCount() > child.conflictSet.getConflictCount()) {
-                    open.insert(child);
-                    if (config.withFocalSearch) {
-                        sumLb.insert(child.sumLb);
-                    }
+            for (auto child : children) {
+                if (child->pathFound && config.withBypassing && cur->cost == child->cost &&
+                        conflictSet.getConflictCount() > child->conflictSet.getConflictCount()) {
+                    insertNode(child);
                     bypass = true;
                     break;
                 }
             }
         }
         if (!bypass && !children.empty()) {
-            if (config.withDisjointSplitting) {
-                children[0].hasPositiveConstraint = true;
-                int id1 = children[0].paths.begin()->first;
+            if (config.withDisjointSplitting && !symmetric && !isMerged(conflict.id1) && !isMerged(conflict.id2)) {
+                CBSNode<SearchType> &child = *children[0];
+                child.hasPositiveConstraint = true;
+                int id1 = child.paths.begin()->first;
                 int id2 = conflict.id1 == id1 ? conflict.id2 : conflict.id1;
                 Constraint positiveConstraint;
                 if (conflict.edgeConflict) {
-                    positiveConstraint = Constraint(children[0].constraint.prev_i, children[0].constraint.prev_j,
-                            conflict.time, id2, children[0].constraint.i, children[0].constraint.j);
+                    positiveConstraint = Constraint(child.constraint.prev_i, child.constraint.prev_j,
+                            conflict.time, id2, child.constraint.i, child.constraint.j);
                 } else {
-                    positiveConstraint = Constraint(children[0].constraint.i, children[0].constraint.j, conflict.time, id2);
+                    positiveConstraint = Constraint(child.constraint.i, child.constraint.j, conflict.time, id2);
                 }
                 positiveConstraint.positive = true;
-                children[0].positiveConstraint = positiveConstraint;
+                child.positiveConstraint = positiveConstraint;
+                child.constraints[id2] = addToConstraintsList(positiveConstraint, constraints[id2]);
             }
 
-            for (auto& child : children) {
-                open.insert(child);
-                if (config.withFocalSearch) {
-                    sumLb.insert(child.sumLb);
-                }
+            for (auto child : children) {
+                insertNode(child);
             }
         }
     }
@@ -589,6 +1192,20 @@ MultiagentSearchResult ConflictBasedSearch<SearchType>::startSearch(const Map &m
 
 template class CBSNode<Astar<>>;
 template class CBSNode<FocalSearch<>>;
+template class CBSNode<Astar<Node, IndexedHeapQueue<Node>>>;
+template class CBSNode<FocalSearch<FSNode, IndexedHeapQueue<FSNode>>>;
+template class CBSNode<Astar<Node, BucketQueue<Node>>>;
+template class CBSNode<FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>>;
+template class CBSNode<SearchEngine<Astar<SearchNode, BucketQueue<SearchNode>>>>;
+template class CBSNode<SearchEngine<FocalSearch<SearchNode, FocalQueue<SearchNode>>>>;
+template class CBSNode<SearchEngine<SIPP<>>>;
 
 template class ConflictBasedSearch<Astar<>>;
 template class ConflictBasedSearch<FocalSearch<>>;
+template class ConflictBasedSearch<Astar<Node, IndexedHeapQueue<Node>>>;
+template class ConflictBasedSearch<FocalSearch<FSNode, IndexedHeapQueue<FSNode>>>;
+template class ConflictBasedSearch<Astar<Node, BucketQueue<Node>>>;
+template class ConflictBasedSearch<FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>>;
+template class ConflictBasedSearch<SearchEngine<Astar<SearchNode, BucketQueue<SearchNode>>>>;
+template class ConflictBasedSearch<SearchEngine<FocalSearch<SearchNode, FocalQueue<SearchNode>>>>;
+template class ConflictBasedSearch<SearchEngine<SIPP<>>>;
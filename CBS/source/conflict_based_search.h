@@ -9,7 +9,12 @@
 #include "conflict_avoidance_table.h"
 #include "mdd.h"
 #include "conflict_set.h"
+#include "path.h"
+#include "path_table.h"
+#include "wdg_heuristic.h"
+#include "symmetry_reasoning.h"
 #include <numeric>
+#include <deque>
 
 template <typename SearchType = Astar<>>
 class ConflictBasedSearch : public MultiagentSearchInterface
@@ -22,27 +27,40 @@ class ConflictBasedSearch : public MultiagentSearchInterface
         MultiagentSearchResult startSearch(const Map &map, const Config &config, AgentSet &agentSet,
            std::chrono::steady_clock::time_point globalBegin = std::chrono::steady_clock::time_point(),
            int globalTimeLimit = -1);
-        template<typename Iter>
-        static ConflictSet findConflict(const std::vector<Iter> &starts, const std::vector<Iter> &ends,
+        static ConflictSet findConflict(const std::vector<const Path*> &paths,
                                         int agentId = -1, bool findAllConflicts = false,
-                                        bool withCardinalConflicts = false, const std::vector<MDD> &mdds = std::vector<MDD>());
-
-        std::set<CBSNode<SearchType>> open;
-        std::list<CBSNode<SearchType>> close;
-        std::set<CBSNode<SearchType>, bool (*)(const CBSNode<SearchType>&, const CBSNode<SearchType>&)> focal;
-        std::multiset<double> sumLb;
+                                        bool withCardinalConflicts = false, const std::vector<MDD> &mdds = std::vector<MDD>(),
+                                        const PathTable *pathTable = nullptr);
+
+        // all generated CT nodes, OPEN, FOCAL and CLOSE keep pointers to them, which stay valid until clear()
+        std::deque<CBSNode<SearchType>> nodes;
+        std::set<CBSNode<SearchType>*, CBSNodePtrLess<SearchType>> open;
+        std::vector<CBSNode<SearchType>*> close;
+        std::set<CBSNode<SearchType>*, bool (*)(const CBSNode<SearchType>*, const CBSNode<SearchType>*)> focal;
+        // nodes of OPEN and FOCAL by the sums of the lower bounds of their paths, CLEANUP in EECBS
+        std::set<CBSNode<SearchType>*, CBSNodeLbLess<SearchType>> sumLb;
+        MDDCache mddCache;
+        WDGHeuristic wdgHeuristic;
+        SymmetryReasoning symmetryReasoning;
 
         SearchType*                     search;
         std::vector<SearchType>         rootSearches;
         int                             bestKnownCost = CN_INFINITY;
+        // groups of agents that are planned together after they have conflicted too often, sorted,
+        // and the group of every agent. Merges restart the search, so they hold for the whole tree
+        std::vector<std::vector<int>>   metaAgents;
+        std::vector<int>                metaAgentIds;
+        // sums of the errors of the cost and of the number of conflicts per expansion in EECBS
+        double                          costErrorSum = 0;
+        double                          conflictsErrorSum = 0;
+        int                             errorsCount = 0;
 
         void createNode(const Map &map, const AgentSet &agentSet, const Config &config,
             const Conflict &conflict, std::vector<int> &costs,
-            ConstraintsSet &constraints, int id1,
-            const Node &pos1, const Node &pos2,
-            std::vector<std::list<Node>::iterator> &starts,
-            std::vector<std::list<Node>::iterator> &ends,
-            ConflictAvoidanceTable &CAT, ConflictSet &conflictSet,
+            std::vector<ConstraintsList> &constraints, int id1,
+            const Constraint &constraint,
+            std::vector<const Path*> &paths,
+            ConflictAvoidanceTable &CAT, const PathTable &pathTable, ConflictSet &conflictSet,
             std::vector<MDD> &mdds, std::vector<double> &lb,
             std::vector<int> &LLExpansions, std::vector<int> &LLNodes,
             CBSNode<SearchType> *parentPtr,
@@ -51,25 +69,58 @@ class ConflictBasedSearch : public MultiagentSearchInterface
             std::chrono::steady_clock::time_point globalBegin = std::chrono::steady_clock::time_point(),
             int globalTimeLimit = -1);
 
+        // constraints of the children of a node split on the conflict, length constraints if it is a target one,
+        // range or barrier constraints if it is a corridor or rectangle one. A rectangle conflict of other agents
+        // can be taken instead of the conflict, then it is replaced. Returns true if the constraints are not the usual ones
+        bool getConstraints(const Map &map, const Config &config, const ConflictSet &conflictSet,
+            const std::vector<const Path*> &paths, const std::vector<MDD> &mdds,
+            const std::vector<ConstraintsList> &constraints, Conflict &conflict,
+            Constraint &constraint1, Constraint &constraint2);
+
         void getState(const std::vector<int> &costs, int &oldCost,
-            const std::vector<std::list<Node>::iterator> &starts, std::list<Node>::iterator& oldStart,
-            const std::vector<std::list<Node>::iterator> &ends, std::list<Node>::iterator& oldEnd,
+            const std::vector<const Path*> &paths, const Path*& oldPath,
             const std::vector<MDD> &mdds, MDD& oldMDD,
             const std::vector<double> &lb, double& oldLb,
             int agentId, bool withMDD, bool withLb);
 
         void setState(std::vector<int> &costs, int oldCost,
-            std::vector<std::list<Node>::iterator> &starts, std::list<Node>::iterator oldStart,
-            std::vector<std::list<Node>::iterator> &ends, std::list<Node>::iterator oldEnd,
+            std::vector<const Path*> &paths, const Path* oldPath,
             std::vector<MDD> &mdds, const MDD& oldMDD,
             std::vector<double> &lb, double oldLb,
             int agentId, bool withMDD, bool withLb);
 
+        // cost of the node with the cost to go estimated by the learned errors. The conflicts error is clamped
+        // to 0.99, so the estimate stays finite when expansions on average do not decrease the conflicts
+        int getEstimatedCost(const CBSNode<SearchType> &node) const;
+
     private:
-        std::list<Node> getNewPath(const Map &map, const AgentSet &agentSet, const Agent &agent,
+        MultiagentSearchResult findSolution(const Map &map, const Config &config, const AgentSet &agentSet,
+           const std::vector<ConstraintsList> &rootConstraints,
+           std::chrono::steady_clock::time_point globalBegin = std::chrono::steady_clock::time_point(),
+           int globalTimeLimit = -1);
+
+        // root with the paths of all agents under their root constraints, false if some agent has no path in time
+        bool createRoot(const Map &map, const Config &config, const AgentSet &agentSet,
+           const std::vector<ConstraintsList> &rootConstraints,
+           std::chrono::steady_clock::time_point begin,
+           std::chrono::steady_clock::time_point globalBegin, int globalTimeLimit);
+
+        // optimal conflict-free paths of the agents of a meta-agent under their constraints, found by CBS
+        // with the same low-level search, empty if there are none
+        std::vector<Path> getMetaAgentPaths(const Map &map, const Config &config, const AgentSet &agentSet,
+           const std::vector<int> &agents, const std::vector<ConstraintsList> &constraints,
+           std::chrono::steady_clock::time_point globalBegin, int globalTimeLimit);
+
+        // conflicts between the meta-agents of the conflict agents in the branch of the node, the conflict included
+        int getBranchConflictsCount(const CBSNode<SearchType> *node, const Conflict &conflict) const;
+
+        bool isMerged(int agentId) const {
+            return metaAgents[metaAgentIds[agentId]].size() > 1;
+        }
+
+        Path getNewPath(const Map &map, const AgentSet &agentSet, const Agent &agent,
                                    const Constraint &constraint, const ConstraintsSet &constraints,
-                                   const std::list<Node>::iterator pathStart,
-                                   const std::list<Node>::iterator pathEnd,
+                                   const Path &oldPath,
                                    bool withCAT, const ConflictAvoidanceTable &CAT, std::vector<double> &lb,
                                    std::vector<int> &LLExpansions, std::vector<int> &LLNodes,
                                    SearchType *search, bool freshStart,
@@ -78,101 +129,4 @@ class ConflictBasedSearch : public MultiagentSearchInterface
 
 };
 
-template<typename SearchType>
-template<typename Iter>
-ConflictSet ConflictBasedSearch<SearchType>::findConflict(const std::vector<Iter> &starts, const std::vector<Iter> &ends,
-                                           int agentId, bool findAllConflicts,
-                                           bool withCardinalConflicts, const std::vector<MDD> &mdds) {
-    ConflictSet conflictSet;
-    std::vector<Iter> iters = starts;
-    std::vector<int> order;
-    for (int i = 0; i < iters.size(); ++i) {
-        if (i != agentId) {
-            order.push_back(i);
-        }
-    }
-    if (agentId != -1) {
-        order.push_back(agentId);
-    }
-    for (int time = 0;; ++time) {
-        std::unordered_multimap<Node, int> positions;
-        std::unordered_multimap<std::pair<Node, Node>, int> edges;
-        std::vector<int> ids;
-
-        int finished = 0;
-        for (int i : order) {
-            if (agentId == -1 || i == agentId) {
-                auto posRange = positions.equal_range(*iters[i]);
-                for (auto posIt = posRange.first; posIt != posRange.second; ++posIt) {
-                    Conflict conflict(i, posIt->second, *iters[i], *iters[i], time, false);
-                    int id1 = i, id2 = posIt->second;
-                    int size1 = 0, size2 = 0;
-                    if (withCardinalConflicts) {
-                        size1 = mdds[id1].getLayerSize(time);
-                        size2 = mdds[id2].getLayerSize(time);
-                    }
-
-                    if (size1 == 1 && size2 == 1) {
-                        conflictSet.addCardinalConflict(conflict);
-                        if (!findAllConflicts) {
-                            return conflictSet;
-                        }
-                    } else if (size1 == 1 || size2 == 1) {
-                        conflictSet.addSemiCardinalConflict(conflict);
-                    } else {
-                        conflictSet.addNonCardinalConflict(conflict);
-                    }
-                    if (!findAllConflicts && !withCardinalConflicts) {
-                        return conflictSet;
-                    }
-                }
-            }
-            positions.insert(std::make_pair(*iters[i], i));
-
-            if (std::next(iters[i]) != ends[i]) {
-                if (agentId == -1 || i == agentId) {
-                    auto edgeRange = edges.equal_range(std::make_pair(*std::next(iters[i]), *iters[i]));
-                    for (auto edgeIt = edgeRange.first; edgeIt != edgeRange.second; ++edgeIt) {
-                        Conflict conflict(i, edgeIt->second, *iters[i], *std::next(iters[i]), time + 1, true);
-                        int id1 = i, id2 = edgeIt->second;
-                        int inSize1 = 0, outSize1 = 0, inSize2 = 0, outSize2 = 0;
-                        if (withCardinalConflicts) {
-                            inSize1 = mdds[id1].getLayerSize(time);
-                            outSize1 = mdds[id1].getLayerSize(time + 1);
-                            inSize2 = mdds[id2].getLayerSize(time);
-                            outSize2 = mdds[id2].getLayerSize(time + 1);
-                        }
-
-                        if ((inSize1 == 1 && outSize1 == 1) && (inSize1 == 2 && outSize2 == 1)) {
-                            conflictSet.addCardinalConflict(conflict);
-                            if (!findAllConflicts) {
-                                return conflictSet;
-                            }
-                        } else if ((inSize1 == 1 && outSize1 == 1) || (inSize2 == 1 && outSize2 == 1)) {
-                            conflictSet.addSemiCardinalConflict(conflict);
-                        } else {
-                            conflictSet.addNonCardinalConflict(conflict);
-                        }
-                        if (!findAllConflicts && !withCardinalConflicts) {
-                            return conflictSet;
-                        }
-                    }
-                }
-                edges.insert(std::make_pair(std::make_pair(*iters[i], *std::next(iters[i])), i));
-            }
-
-            if (std::next(iters[i]) != ends[i]) {
-                ++iters[i];
-            } else {
-                ++finished;
-            }
-        }
-
-        if (finished == iters.size()) {
-            break;
-        }
-    }
-    return conflictSet;
-}
-
 #endif // CONFLICT_BASED_SEARCH_H
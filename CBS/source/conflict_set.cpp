@@ -1,60 +1,144 @@
 #include "conflict_set.h"
 
+ConflictSet::ConflictRow& ConflictSet::getMutableRow(int agentId) {
+    if (agentId >= int(rows.size())) {
+        rows.resize(agentId + 1);
+    }
+    std::shared_ptr<ConflictRow> &row = rows[agentId];
+    if (row == nullptr) {
+        row = std::make_shared<ConflictRow>();
+    } else if (row.use_count() > 1) {
+        row = std::make_shared<ConflictRow>(*row);
+    }
+    return *row;
+}
+
+void ConflictSet::addConflict(const Conflict &conflict, std::vector<Conflict> ConflictRow::*kind) {
+    (getMutableRow(conflict.id1).*kind).push_back(conflict);
+    (getMutableRow(conflict.id2).*kind).push_back(conflict);
+}
+
 void ConflictSet::addCardinalConflict(Conflict &conflict) {
-    cardinal.push_back(conflict);
+    addConflict(conflict, &ConflictRow::cardinal);
+    ++cardinalCount;
 }
 
 void ConflictSet::addSemiCardinalConflict(Conflict &conflict) {
-    semiCardinal.push_back(conflict);
+    addConflict(conflict, &ConflictRow::semiCardinal);
+    ++semiCardinalCount;
 }
 
 void ConflictSet::addNonCardinalConflict(Conflict &conflict) {
-    nonCardinal.push_back(conflict);
+    addConflict(conflict, &ConflictRow::nonCardinal);
+    ++nonCardinalCount;
 }
 
-void ConflictSet::replaceAgentConflicts(int agentId, ConflictSet &agentConflicts) {
-    std::vector<Conflict> newCardinal, newSemiCardinal, newNonCardinal;
-    auto pred = [agentId](Conflict conflict) {return conflict.id1 != agentId && conflict.id2 != agentId;};
-    std::copy_if(cardinal.begin(), cardinal.end(), std::back_inserter(newCardinal), pred);
-    std::copy_if(semiCardinal.begin(), semiCardinal.end(), std::back_inserter(newSemiCardinal), pred);
-    std::copy_if(nonCardinal.begin(), nonCardinal.end(), std::back_inserter(newNonCardinal), pred);
-    newCardinal.insert(newCardinal.end(), agentConflicts.cardinal.begin(), agentConflicts.cardinal.end());
-    newSemiCardinal.insert(newSemiCardinal.end(), agentConflicts.semiCardinal.begin(), agentConflicts.semiCardinal.end());
-    newNonCardinal.insert(newNonCardinal.end(), agentConflicts.nonCardinal.begin(), agentConflicts.nonCardinal.end());
-    cardinal = newCardinal;
-    semiCardinal = newSemiCardinal;
-    nonCardinal = newNonCardinal;
+void ConflictSet::removeAgentConflicts(int agentId) {
+    if (agentId >= int(rows.size()) || rows[agentId] == nullptr) {
+        return;
+    }
+    std::shared_ptr<const ConflictRow> row = rows[agentId];
+    rows[agentId].reset();
+    cardinalCount -= row->cardinal.size();
+    semiCardinalCount -= row->semiCardinal.size();
+    nonCardinalCount -= row->nonCardinal.size();
+
+    // every agent the agent conflicts with loses all its conflicts with the agent at once
+    std::unordered_set<int> others;
+    for (const std::vector<Conflict> *conflicts : {&row->cardinal, &row->semiCardinal, &row->nonCardinal}) {
+        for (const Conflict &conflict : *conflicts) {
+            others.insert(getOtherAgent(conflict, agentId));
+        }
+    }
+    auto pred = [agentId](const Conflict &conflict) {return conflict.id1 == agentId || conflict.id2 == agentId;};
+    for (int other : others) {
+        ConflictRow &otherRow = getMutableRow(other);
+        for (std::vector<Conflict> *conflicts : {&otherRow.cardinal, &otherRow.semiCardinal, &otherRow.nonCardinal}) {
+            conflicts->erase(std::remove_if(conflicts->begin(), conflicts->end(), pred), conflicts->end());
+        }
+    }
+}
+
+void ConflictSet::replaceAgentConflicts(int agentId, const ConflictSet &agentConflicts) {
+    removeAgentConflicts(agentId);
+    if (agentId >= int(agentConflicts.rows.size()) || agentConflicts.rows[agentId] == nullptr) {
+        return;
+    }
+    const ConflictRow &row = *agentConflicts.rows[agentId];
+    for (const Conflict &conflict : row.cardinal) {
+        addConflict(conflict, &ConflictRow::cardinal);
+    }
+    for (const Conflict &conflict : row.semiCardinal) {
+        addConflict(conflict, &ConflictRow::semiCardinal);
+    }
+    for (const Conflict &conflict : row.nonCardinal) {
+        addConflict(conflict, &ConflictRow::nonCardinal);
+    }
+    cardinalCount += row.cardinal.size();
+    semiCardinalCount += row.semiCardinal.size();
+    nonCardinalCount += row.nonCardinal.size();
 }
 
 bool ConflictSet::empty() const {
-    return cardinal.empty() && semiCardinal.empty() && nonCardinal.empty();
+    return getConflictCount() == 0;
 }
 
-Conflict ConflictSet::getBestConflict() {
-    if (!cardinal.empty()) {
-        return cardinal[0];
-    } else if (!semiCardinal.empty()) {
-        return semiCardinal[0];
+Conflict ConflictSet::getBestConflict() const {
+    // the first conflict of the best kind in the order of pairs
+    for (auto kind : {&ConflictRow::cardinal, &ConflictRow::semiCardinal, &ConflictRow::nonCardinal}) {
+        for (int agentId = 0; agentId < int(rows.size()); ++agentId) {
+            if (rows[agentId] == nullptr) {
+                continue;
+            }
+            for (const Conflict &conflict : (*rows[agentId]).*kind) {
+                if (getOtherAgent(conflict, agentId) > agentId) {
+                    return conflict;
+                }
+            }
+        }
     }
-    return nonCardinal[0];
+    return Conflict();
 }
 
 int ConflictSet::getCardinalConflictCount() const {
-    return cardinal.size();
+    return cardinalCount;
 }
 
 int ConflictSet::getConflictCount() const {
-    return cardinal.size() + semiCardinal.size() + nonCardinal.size();
+    return cardinalCount + semiCardinalCount + nonCardinalCount;
+}
+
+std::vector<Conflict> ConflictSet::getConflicts(std::vector<Conflict> ConflictRow::*kind) const {
+    std::vector<Conflict> res;
+    for (int agentId = 0; agentId < int(rows.size()); ++agentId) {
+        if (rows[agentId] == nullptr) {
+            continue;
+        }
+        for (const Conflict &conflict : (*rows[agentId]).*kind) {
+            if (getOtherAgent(conflict, agentId) > agentId) {
+                res.push_back(conflict);
+            }
+        }
+    }
+    return res;
 }
 
 std::vector<Conflict> ConflictSet::getCardinalConflicts() const {
-    return cardinal;
+    return cardinalCount == 0 ? std::vector<Conflict>() : getConflicts(&ConflictRow::cardinal);
 }
 
-int ConflictSet::getMatchingHeuristic() {
+std::vector<Conflict> ConflictSet::getSemiCardinalConflicts() const {
+    return semiCardinalCount == 0 ? std::vector<Conflict>() : getConflicts(&ConflictRow::semiCardinal);
+}
+
+std::vector<Conflict> ConflictSet::getNonCardinalConflicts() const {
+    return nonCardinalCount == 0 ? std::vector<Conflict>() : getConflicts(&ConflictRow::nonCardinal);
+}
+
+int ConflictSet::getMatchingHeuristic() const {
     std::unordered_set<int> matched;
     int res = 0;
-    for (const auto& conflict : cardinal) {
+    for (const auto& conflict : getCardinalConflicts()) {
         if (matched.find(conflict.id1) == matched.end() && matched.find(conflict.id2) == matched.end()) {
             ++res;
             matched.insert(conflict.id1);
@@ -64,20 +148,26 @@ int ConflictSet::getMatchingHeuristic() {
     return res;
 }
 
-int ConflictSet::getConflictingPairsCount() {
-    std::set<std::pair<int, int>> conflictingPairs;
-    std::vector<std::vector<Conflict>::iterator> begins = {nonCardinal.begin(), semiCardinal.begin(), cardinal.begin()};
-    std::vector<std::vector<Conflict>::iterator> ends = {nonCardinal.end(), semiCardinal.end(), cardinal.end()};
-    for (int i = 0; i < 3; ++i) {
-        for (auto it = begins[i]; it != ends[i]; ++it) {
-            auto pair = std::make_pair(it->id1, it->id2);
-            if (pair.first > pair.second) {
-                std::swap(pair.first, pair.second);
+int ConflictSet::getConflictingPairsCount() const {
+    // every pair is counted in the row of its lesser agent
+    int res = 0;
+    std::vector<int> others;
+    for (int agentId = 0; agentId < int(rows.size()); ++agentId) {
+        if (rows[agentId] == nullptr) {
+            continue;
+        }
+        others.clear();
+        for (const std::vector<Conflict> *conflicts :
+                {&rows[agentId]->cardinal, &rows[agentId]->semiCardinal, &rows[agentId]->nonCardinal}) {
+            for (const Conflict &conflict : *conflicts) {
+                int other = getOtherAgent(conflict, agentId);
+                if (other > agentId) {
+                    others.push_back(other);
+                }
             }
-            conflictingPairs.insert(std::make_pair(it->id1, it->id2));
         }
+        std::sort(others.begin(), others.end());
+        res += std::unique(others.begin(), others.end()) - others.begin();
     }
-    return conflictingPairs.size();
+    return res;
 }
-
-
@@ -2,28 +2,49 @@
 #define CONFLICTSET_H
 
 #include <vector>
+#include <memory>
 #include <algorithm>
 #include <unordered_set>
 #include <set>
 #include "conflict.h"
 #include "node.h"
 
+// Conflicts of a CT node indexed by agent. The row of an agent holds its conflicts with every other agent,
+// so a conflict is in the rows of both its agents. Rows are shared between a node and its children and
+// copied only when changed, so replacing the conflicts of a replanned agent copies its row and the rows of
+// the agents it conflicts with. Conflicts are listed in the order of pairs (id1 < id2) and then of insertion.
 class ConflictSet
 {
 public:
     void addCardinalConflict(Conflict &conflict);
     void addSemiCardinalConflict(Conflict &conflict);
     void addNonCardinalConflict(Conflict &conflict);
-    void replaceAgentConflicts(int agentId, ConflictSet &agentConflicts);
+    void replaceAgentConflicts(int agentId, const ConflictSet &agentConflicts);
+    void removeAgentConflicts(int agentId);
     bool empty() const;
-    Conflict getBestConflict();
+    Conflict getBestConflict() const;
     int getConflictCount() const;
     int getCardinalConflictCount() const;
     std::vector<Conflict> getCardinalConflicts() const;
-    int getMatchingHeuristic();
-    int getConflictingPairsCount();
+    std::vector<Conflict> getSemiCardinalConflicts() const;
+    std::vector<Conflict> getNonCardinalConflicts() const;
+    int getMatchingHeuristic() const;
+    int getConflictingPairsCount() const;
 //private:
-    std::vector<Conflict> cardinal, semiCardinal, nonCardinal;
+    struct ConflictRow
+    {
+        std::vector<Conflict> cardinal, semiCardinal, nonCardinal;
+    };
+
+    static int getOtherAgent(const Conflict &conflict, int agentId) {
+        return conflict.id1 == agentId ? conflict.id2 : conflict.id1;
+    }
+    ConflictRow& getMutableRow(int agentId);
+    void addConflict(const Conflict &conflict, std::vector<Conflict> ConflictRow::*kind);
+    std::vector<Conflict> getConflicts(std::vector<Conflict> ConflictRow::*kind) const;
+
+    std::vector<std::shared_ptr<ConflictRow>>   rows;
+    int                                         cardinalCount = 0, semiCardinalCount = 0, nonCardinalCount = 0;
 };
 
 #endif // CONFLICTSET_H
@@ -3,6 +3,7 @@
 
 #include <unordered_set>
 #include <tuple>
+#include <cstdlib>
 
 struct Constraint
 {
@@ -11,6 +12,8 @@ struct Constraint
     int     dur;
     int     agentId;
     int     prev_i, prev_j;
+    int     end_i, end_j;  // last cell of a barrier, its k-th cell from (i, j) is constrained at time + k
+    int     length;        // 1 if the path of the agent has to end in its goal (i, j) after time, -1 if not after it
     bool    goalNode;
     bool    positive;
 
@@ -24,21 +27,42 @@ struct Constraint
         goalNode = GoalNode;
         positive = false;
         dur = 1;
+        end_i = -1;
+        end_j = -1;
+        length = 0;
+    }
+
+    // calls f(i, j, time) for the vertex constraints this constraint stands for: one for a vertex constraint,
+    // one per time from time to time + dur - 1 for a range constraint and one per cell for a barrier constraint
+    template<typename F>
+    void forEachVertex(F f) const {
+        if (end_i == -1) {
+            for (int t = time; t < time + dur; ++t) {
+                f(i, j, t);
+            }
+            return;
+        }
+        int di = (end_i > i) - (end_i < i), dj = (end_j > j) - (end_j < j);
+        int length = std::abs(end_i - i) + std::abs(end_j - j);
+        for (int k = 0; k <= length; ++k) {
+            f(i + k * di, j + k * dj, time + k);
+        }
     }
 
     bool operator== (const Constraint &other) const {
         return i == other.i && j == other.j && time == other.time &&
             prev_i == other.prev_i && prev_j == other.prev_j &&
-            goalNode == other.goalNode && agentId == other.agentId;
+            goalNode == other.goalNode && agentId == other.agentId &&
+            dur == other.dur && end_i == other.end_i && end_j == other.end_j && length == other.length;
     }
     bool operator!= (const Constraint &other) const {
         return !(*this == other);
     }
 
     bool operator< (const Constraint &other) const {
-        return std::tuple<int, int, int, int, int, bool, int>(i, j, prev_i, prev_j, time, goalNode, agentId) <
-            std::tuple<int, int, int, int, int, bool, int>(
-                other.i, other.j, other.prev_i, other.prev_j, other.time, other.goalNode, other.agentId);
+        return std::make_tuple(i, j, prev_i, prev_j, time, goalNode, agentId, dur, end_i, end_j, length) <
+            std::make_tuple(other.i, other.j, other.prev_i, other.prev_j, other.time, other.goalNode,
+                            other.agentId, other.dur, other.end_i, other.end_j, other.length);
     }
 };
 
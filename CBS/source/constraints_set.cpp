@@ -1,78 +1,150 @@
 #include "constraints_set.h"
 
 void ConstraintsSet::addNodeConstraint(int i, int j, int time, int agentId) {
-    nodeConstraints.insert(Constraint(i, j, time, agentId));
+    insertEntry(getCell(i, j).nodes, NodeEntry{time, 1, agentId});
 }
 
 void ConstraintsSet::addGoalNodeConstraint(int i, int j, int time, int agentId) {
-    goalNodeConstraints.insert(Constraint(i, j, time, agentId, -1, -1, true));
+    insertEntry(getCell(i, j).goals, NodeEntry{time, 1, agentId});
 }
 
 void ConstraintsSet::addEdgeConstraint(int i, int j, int time, int agentId, int prevI, int prevJ) {
-    edgeConstraints.insert(Constraint(i, j, time, agentId, prevI, prevJ));
+    insertEntry(getCell(i, j).edges, EdgeEntry{time, prevI, prevJ, agentId});
 }
 
 void ConstraintsSet::addPositiveConstraint(int i, int j, int time, int agentId, int prevI, int prevJ) {
     positiveConstraints.emplace_back(i, j, time, agentId, prevI, prevJ);
 }
 
-void ConstraintsSet::addConstraint(Constraint &constraint) {
-    if (constraint.positive) {
+void ConstraintsSet::addConstraint(const Constraint &constraint) {
+    if (constraint.length == 1) {
+        insertEntry(getCell(constraint.i, constraint.j).minGoalTimes,
+                    NodeEntry{constraint.time + 1, 1, constraint.agentId});
+    } else if (constraint.length == -1) {
+        insertEntry(getCell(constraint.i, constraint.j).maxGoalTimes,
+                    NodeEntry{constraint.time, 1, constraint.agentId});
+    } else if (constraint.positive) {
         positiveConstraints.push_back(constraint);
     } else if (constraint.prev_i == -1) {
         if (constraint.goalNode) {
-            goalNodeConstraints.insert(constraint);
+            insertEntry(getCell(constraint.i, constraint.j).goals,
+                        NodeEntry{constraint.time, constraint.dur, constraint.agentId});
         } else {
-            nodeConstraints.insert(constraint);
+            // range and barrier constraints are kept as their vertex constraints
+            constraint.forEachVertex([&](int i, int j, int time) {
+                insertEntry(getCell(i, j).nodes, NodeEntry{time, 1, constraint.agentId});
+            });
         }
     } else {
-        edgeConstraints.insert(constraint);
+        insertEntry(getCell(constraint.i, constraint.j).edges,
+                    EdgeEntry{constraint.time, constraint.prev_i, constraint.prev_j, constraint.agentId});
     }
 }
 
-void ConstraintsSet::removeConstraint(Constraint &constraint) {
-    if (constraint.prev_i == -1) {
+void ConstraintsSet::addConstraints(const ConstraintsList &list) {
+    for (const ConstraintsListNode *cur = list.get(); cur != nullptr; cur = cur->next.get()) {
+        addConstraint(cur->constraint);
+    }
+}
+
+void ConstraintsSet::removeConstraint(const Constraint &constraint) {
+    if (constraint.length == 1) {
+        eraseEntry(getCell(constraint.i, constraint.j).minGoalTimes,
+                   NodeEntry{constraint.time + 1, 1, constraint.agentId});
+    } else if (constraint.length == -1) {
+        eraseEntry(getCell(constraint.i, constraint.j).maxGoalTimes,
+                   NodeEntry{constraint.time, 1, constraint.agentId});
+    } else if (constraint.prev_i == -1) {
         if (constraint.goalNode) {
-            goalNodeConstraints.erase(constraint);
+            removeGoalNodeConstraint(constraint.i, constraint.j, constraint.time, constraint.agentId);
         } else {
-            nodeConstraints.erase(constraint);
+            constraint.forEachVertex([&](int i, int j, int time) {
+                removeNodeConstraint(i, j, time, constraint.agentId);
+            });
         }
     } else {
-        edgeConstraints.erase(constraint);
+        removeEdgeConstraint(constraint.i, constraint.j, constraint.time, constraint.agentId,
+                             constraint.prev_i, constraint.prev_j);
     }
 }
 
 void ConstraintsSet::removeNodeConstraint(int i, int j, int time, int agentId) {
-    nodeConstraints.erase(Constraint(i, j, time, agentId));
+    eraseEntry(getCell(i, j).nodes, NodeEntry{time, 1, agentId});
 }
 
 void ConstraintsSet::removeGoalNodeConstraint(int i, int j, int time, int agentId) {
-    goalNodeConstraints.erase(Constraint(i, j, time, agentId, -1, -1, true));
+    eraseEntry(getCell(i, j).goals, NodeEntry{time, 1, agentId});
 }
 
 void ConstraintsSet::removeEdgeConstraint(int i, int j, int time, int agentId, int prevI, int prevJ) {
-    edgeConstraints.erase(Constraint(i, j, time, agentId, prevI, prevJ));
+    eraseEntry(getCell(i, j).edges, EdgeEntry{time, prevI, prevJ, agentId});
 }
 
 void ConstraintsSet::removeLastPositiveConstraint() {
     positiveConstraints.pop_back();
 }
 
-ConstraintsSet ConstraintsSet::getAgentConstraints(int agentId) const {
-    ConstraintsSet res;
-    for (auto constraint : nodeConstraints) {
-        if (constraint.agentId == agentId) {
-            res.nodeConstraints.insert(constraint);
+void ConstraintsSet::addAgentPath(const Path &path, int agentId) {
+    for (int time = 0; time < path.size(); ++time) {
+        if (time + 1 == path.size()) {
+            addGoalNodeConstraint(path.getI(time), path.getJ(time), time, agentId);
+        } else {
+            addNodeConstraint(path.getI(time), path.getJ(time), time, agentId);
+        }
+        if (time > 0) {
+            addEdgeConstraint(path.getI(time - 1), path.getJ(time - 1), time, agentId, path.getI(time), path.getJ(time));
         }
     }
-    for (auto constraint : edgeConstraints) {
-        if (constraint.agentId == agentId) {
-            res.edgeConstraints.insert(constraint);
+}
+
+void ConstraintsSet::removeAgentPath(const Path &path, int agentId) {
+    for (int time = 0; time < path.size(); ++time) {
+        if (time + 1 == path.size()) {
+            removeGoalNodeConstraint(path.getI(time), path.getJ(time), time, agentId);
+        } else {
+            removeNodeConstraint(path.getI(time), path.getJ(time), time, agentId);
+        }
+        if (time > 0) {
+            removeEdgeConstraint(path.getI(time - 1), path.getJ(time - 1), time, agentId, path.getI(time), path.getJ(time));
         }
     }
-    for (auto constraint : goalNodeConstraints) {
-        if (constraint.agentId == agentId) {
-            res.goalNodeConstraints.insert(constraint);
+}
+
+ConstraintsSet ConstraintsSet::getAgentConstraints(int agentId) const {
+    ConstraintsSet res;
+    for (const auto &cell : cells) {
+        CellConstraints *resCell = nullptr;
+        auto getResCell = [&]() -> CellConstraints& {
+            if (resCell == nullptr) {
+                resCell = &res.getCell(cell.i, cell.j);
+            }
+            return *resCell;
+        };
+        // entries are taken in sorted order, so they are appended
+        for (const auto &entry : cell.nodes) {
+            if (entry.agentId == agentId) {
+                getResCell().nodes.push_back(entry);
+            }
+        }
+        for (const auto &entry : cell.edges) {
+            if (entry.agentId == agentId) {
+                getResCell().edges.push_back(entry);
+            }
+        }
+        for (const auto &entry : cell.goals) {
+            if (entry.agentId == agentId) {
+                getResCell().goals.push_back(entry);
+            }
+        }
+        for (const auto &entry : cell.minGoalTimes) {
+            if (entry.agentId == agentId) {
+                getResCell().minGoalTimes.push_back(entry);
+            }
+        }
+        for (const auto &entry : cell.maxGoalTimes) {
+            if (entry.agentId == agentId) {
+                getResCell().maxGoalTimes.push_back(entry);
+            }
         }
     }
     for (auto constraint : positiveConstraints) {
@@ -84,24 +156,40 @@ ConstraintsSet ConstraintsSet::getAgentConstraints(int agentId) const {
 }
 
 bool ConstraintsSet::hasNodeConstraint(int i, int j, int time, int agentId) const {
-    if (nodeConstraints.find(Constraint(i, j, time, agentId)) != nodeConstraints.end()) {
+    const CellConstraints *cell = findCell(i, j);
+    if (cell == nullptr) {
+        return false;
+    }
+    if (std::binary_search(cell->nodes.begin(), cell->nodes.end(), NodeEntry{time, 1, agentId})) {
         return true;
     }
-    auto constraint = goalNodeConstraints.lower_bound(Constraint(i, j, 0));
-    return constraint != goalNodeConstraints.end() && constraint->i == i && constraint->j == j && constraint->time <= time;
+    return !cell->goals.empty() && cell->goals.front().time <= time;
 }
 
 bool ConstraintsSet::hasFutureConstraint(int i, int j, int time, int agentId) const {
-    auto constraint = nodeConstraints.lower_bound(Constraint(i, j, time));
-    if (constraint != nodeConstraints.end() && constraint->i == i && constraint->j == j) {
-        return true;
-    }
-    constraint = goalNodeConstraints.lower_bound(Constraint(i, j, time));
-    return constraint != goalNodeConstraints.end() && constraint->i == i && constraint->j == j;
+    const CellConstraints *cell = findCell(i, j);
+    return cell != nullptr && ((!cell->nodes.empty() && cell->nodes.back().time >= time) ||
+                               (!cell->goals.empty() && cell->goals.back().time >= time));
+}
+
+bool ConstraintsSet::hasGoalConstraints() const {
+    return std::any_of(cells.begin(), cells.end(), [](const CellConstraints &cell) { return !cell.goals.empty(); });
 }
 
 bool ConstraintsSet::hasEdgeConstraint(int i, int j, int time, int agentId, int prevI, int prevJ) const {
-    return edgeConstraints.find(Constraint(i, j, time, agentId, prevI, prevJ)) != edgeConstraints.end();
+    const CellConstraints *cell = findCell(i, j);
+    return cell != nullptr &&
+           std::binary_search(cell->edges.begin(), cell->edges.end(), EdgeEntry{time, prevI, prevJ, agentId});
+}
+
+int ConstraintsSet::getMinGoalTime(int i, int j, int) const {
+    const CellConstraints *cell = findCell(i, j);
+    return cell == nullptr || cell->minGoalTimes.empty() ? 0 : cell->minGoalTimes.back().time;
+}
+
+int ConstraintsSet::getMaxGoalTime(int i, int j, int) const {
+    const CellConstraints *cell = findCell(i, j);
+    return cell == nullptr || cell->maxGoalTimes.empty() ? CN_INFINITY : cell->maxGoalTimes.front().time;
 }
 
 std::vector<Constraint> ConstraintsSet::getPositiveConstraints() const {
@@ -110,24 +198,50 @@ std::vector<Constraint> ConstraintsSet::getPositiveConstraints() const {
 
 int ConstraintsSet::getFirstConstraintTime(int i, int j, int startTime, int agentId) const {
     int res = CN_INFINITY;
-    auto constraint = nodeConstraints.lower_bound(Constraint(i, j, startTime));
-    if (constraint != nodeConstraints.end() && constraint->i == i && constraint->j == j) {
-        res = constraint->time;
+    const CellConstraints *cell = findCell(i, j);
+    if (cell == nullptr) {
+        return res;
+    }
+    auto it = std::lower_bound(cell->nodes.begin(), cell->nodes.end(), NodeEntry{startTime, 1, 0});
+    if (it != cell->nodes.end()) {
+        res = it->time;
+    }
+    it = std::lower_bound(cell->goals.begin(), cell->goals.end(), NodeEntry{startTime, 1, 0});
+    if (it != cell->goals.end() && it->time < res) {
+        res = it->time;
+    }
+    return res;
+}
+
+int ConstraintsSet::getLastConstraintTime() const {
+    int res = -1;
+    for (const auto &cell : cells) {
+        if (!cell.nodes.empty()) {
+            res = std::max(res, cell.nodes.back().time);
+        }
+        if (!cell.edges.empty()) {
+            res = std::max(res, cell.edges.back().time);
+        }
+        if (!cell.goals.empty()) {
+            res = std::max(res, cell.goals.back().time);
+        }
     }
-    constraint = goalNodeConstraints.lower_bound(Constraint(i, j, startTime));
-    if (constraint != goalNodeConstraints.end() && constraint->i == i &&
-            constraint->j == j && constraint->time < res) {
-        res = constraint->time;
+    for (const Constraint &constraint : positiveConstraints) {
+        res = std::max(res, constraint.time);
     }
     return res;
 }
 
 std::vector<std::pair<int, int>> ConstraintsSet::getSafeIntervals(int i, int j, int agentId,
                                                                   int startTime, int endTime) const {
+    const CellConstraints *cell = findCell(i, j);
+    if (cell == nullptr) {
+        return {{0, CN_INFINITY}};
+    }
+
     int goalConstraintTime = -1;
-    auto it = goalNodeConstraints.lower_bound(Constraint(i, j, 0));
-    if (it != goalNodeConstraints.end() && it->i == i && it->j == j) {
-        goalConstraintTime = it->time;
+    if (!cell->goals.empty()) {
+        goalConstraintTime = cell->goals.front().time;
         if (goalConstraintTime <= endTime) {
             endTime = goalConstraintTime - 1;
         }
@@ -137,16 +251,14 @@ std::vector<std::pair<int, int>> ConstraintsSet::getSafeIntervals(int i, int j,
     }
 
     int beg = 0;
-    it = nodeConstraints.upper_bound(Constraint(i, j, startTime, agentId));
-    if (it != nodeConstraints.begin()) {
+    auto it = std::upper_bound(cell->nodes.begin(), cell->nodes.end(), NodeEntry{startTime, 1, agentId});
+    if (it != cell->nodes.begin()) {
         auto pr = std::prev(it);
-        if (pr->i == i && pr->j == j) {
-            beg = pr->time + pr->dur;
-        }
+        beg = pr->time + pr->dur;
     }
 
     std::vector<std::pair<int, int>> res;
-    auto end = nodeConstraints.upper_bound(Constraint(i, j, endTime, agentId));
+    auto end = std::upper_bound(it, cell->nodes.end(), NodeEntry{endTime, 1, agentId});
     for (it; it != end; ++it) {
         if (it->time > beg) {
             res.emplace_back(beg, it->time - 1);
@@ -159,7 +271,7 @@ std::vector<std::pair<int, int>> ConstraintsSet::getSafeIntervals(int i, int j,
         if (goalConstraintTime != -1) {
             endTime = goalConstraintTime - 1;
         }
-        if (end != nodeConstraints.end() && end->i == i && end->j == j && end->time - 1 < endTime) {
+        if (end != cell->nodes.end() && end->time - 1 < endTime) {
             endTime = end->time - 1;
         }
         res.emplace_back(beg, endTime);
@@ -167,3 +279,54 @@ std::vector<std::pair<int, int>> ConstraintsSet::getSafeIntervals(int i, int j,
     return res;
 }
 
+int ConstraintsSet::findSlot(int i, int j) const {
+    int mask = table.size() - 1;
+    int slot = (unsigned(i) * 73856093u ^ unsigned(j) * 19349663u) & mask;
+    while (table[slot] != -1 && (cells[table[slot]].i != i || cells[table[slot]].j != j)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+const ConstraintsSet::CellConstraints* ConstraintsSet::findCell(int i, int j) const {
+    if (cells.empty()) {
+        return nullptr;
+    }
+    int index = table[findSlot(i, j)];
+    return index == -1 ? nullptr : &cells[index];
+}
+
+ConstraintsSet::CellConstraints& ConstraintsSet::getCell(int i, int j) {
+    if (2 * (cells.size() + 1) > table.size()) {
+        rehash(std::max<int>(16, 2 * table.size()));
+    }
+    int slot = findSlot(i, j);
+    if (table[slot] == -1) {
+        table[slot] = cells.size();
+        cells.push_back(CellConstraints{i, j, {}, {}, {}, {}, {}});
+    }
+    return cells[table[slot]];
+}
+
+void ConstraintsSet::rehash(int tableSize) {
+    table.assign(tableSize, -1);
+    for (int k = 0; k < int(cells.size()); ++k) {
+        table[findSlot(cells[k].i, cells[k].j)] = k;
+    }
+}
+
+template<typename Entry>
+void ConstraintsSet::insertEntry(std::vector<Entry> &entries, const Entry &entry) {
+    auto it = std::lower_bound(entries.begin(), entries.end(), entry);
+    if (it == entries.end() || entry < *it) {
+        entries.insert(it, entry);
+    }
+}
+
+template<typename Entry>
+void ConstraintsSet::eraseEntry(std::vector<Entry> &entries, const Entry &entry) {
+    auto it = std::lower_bound(entries.begin(), entries.end(), entry);
+    if (it != entries.end() && !(entry < *it)) {
+        entries.erase(it);
+    }
+}
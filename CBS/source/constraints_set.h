@@ -3,10 +3,31 @@
 
 #include "constraint.h"
 #include "gl_const.h"
-#include <set>
+#include "path.h"
 #include <vector>
 #include <algorithm>
+#include <tuple>
+#include <memory>
 
+// Persistent list of constraints of one agent. A node of the constraint tree adds one constraint to the list of its parent,
+// so the lists of all nodes of a branch share their tails and are never copied.
+struct ConstraintsListNode
+{
+    Constraint                                  constraint;
+    std::shared_ptr<const ConstraintsListNode>  next;
+};
+
+typedef std::shared_ptr<const ConstraintsListNode> ConstraintsList;
+
+inline ConstraintsList addToConstraintsList(const Constraint &constraint, const ConstraintsList &list) {
+    return std::make_shared<const ConstraintsListNode>(ConstraintsListNode{constraint, list});
+}
+
+// Constraints of the low level search indexed by cell. Every constrained cell has sorted vectors of its
+// vertex constraints (by time and agent), edge constraints (by time, previous cell and agent), goal constraints
+// and length constraints, cells are found through a flat open addressing hash table keyed by (i, j). So every check
+// of a successor is a probe into the table, which is empty for most cells, and a binary search among the constraints
+// of one cell.
 class ConstraintsSet
 {
 public:
@@ -14,61 +35,74 @@ public:
     void addGoalNodeConstraint(int i, int j, int time, int agentId);
     void addEdgeConstraint(int i, int j, int time, int agentId, int prevI, int prevJ);
     void addPositiveConstraint(int i, int j, int time, int agentId, int prevI = -1, int prevJ = -1);
-    void addConstraint(Constraint &constraint);
-    void removeConstraint(Constraint &constraint);
-    template<typename Iter> void addAgentPath(Iter start, Iter end, int agentId);
+    void addConstraint(const Constraint &constraint);
+    void addConstraints(const ConstraintsList &list);
+    void removeConstraint(const Constraint &constraint);
+    void addAgentPath(const Path &path, int agentId);
 
     void removeNodeConstraint(int i, int j, int time, int agentId);
     void removeGoalNodeConstraint(int i, int j, int time, int agentId);
     void removeEdgeConstraint(int i, int j, int time, int agentId, int prevI, int prevJ);
     void removeLastPositiveConstraint();
-    template<typename Iter> void removeAgentPath(Iter start, Iter end, int agentId);
+    void removeAgentPath(const Path &path, int agentId);
 
     ConstraintsSet getAgentConstraints(int agentId) const;
     std::vector<Constraint> getPositiveConstraints() const;
     int getFirstConstraintTime(int i, int j, int startTime, int agentId) const;
+    // time of the last node, edge, goal or positive constraint, after it the constraints do not change,
+    // -1 if there are none
+    int getLastConstraintTime() const;
     std::vector<std::pair<int, int>> getSafeIntervals(int i, int j, int agentId, int startTime, int endTime) const;
+    // bounds of the time the agent can end its path in its goal (i, j) set by length constraints
+    int getMinGoalTime(int i, int j, int agentId) const;
+    int getMaxGoalTime(int i, int j, int agentId) const;
 
     bool hasNodeConstraint(int i, int j, int time, int agentId) const;
     bool hasFutureConstraint(int i, int j, int time, int agentId) const;
+    // true if some cell is closed by a goal constraint from its time on
+    bool hasGoalConstraints() const;
     bool hasEdgeConstraint(int i, int j, int time, int agentId, int prevI, int prevJ) const;
 //private:
-    std::set<Constraint> nodeConstraints;
-    std::set<Constraint> edgeConstraints;
-    std::set<Constraint> goalNodeConstraints;
-    std::vector<Constraint> positiveConstraints;
-};
-
-template<typename Iter>
-void ConstraintsSet::addAgentPath(Iter start, Iter end, int agentId) {
-    int time = 0;
-    for (auto it = start; it != end; ++it) {
-        if (std::next(it) == end) {
-            addGoalNodeConstraint(it->i, it->j, time, agentId);
-        } else {
-            addNodeConstraint(it->i, it->j, time, agentId);
-        }
-        if (it != start) {
-            addEdgeConstraint(std::prev(it)->i, std::prev(it)->j, time, agentId, it->i, it->j);
+    struct NodeEntry
+    {
+        int time, dur, agentId;
+        bool operator< (const NodeEntry &other) const {
+            return time < other.time || (time == other.time && agentId < other.agentId);
         }
-        ++time;
-    }
-}
+    };
 
-template<typename Iter>
-void ConstraintsSet::removeAgentPath(Iter start, Iter end, int agentId) {
-    int time = 0;
-    for (auto it = start; it != end; ++it) {
-        if (std::next(it) == end) {
-            removeGoalNodeConstraint(it->i, it->j, time, agentId);
-        } else {
-            removeNodeConstraint(it->i, it->j, time, agentId);
-        }
-        if (it != start) {
-            removeEdgeConstraint(std::prev(it)->i, std::prev(it)->j, time, agentId, it->i, it->j);
+    struct EdgeEntry
+    {
+        int time, prevI, prevJ, agentId;
+        bool operator< (const EdgeEntry &other) const {
+            return std::tie(time, prevI, prevJ, agentId) < std::tie(other.time, other.prevI, other.prevJ, other.agentId);
         }
-        ++time;
-    }
-}
+    };
+
+    struct CellConstraints
+    {
+        int                     i, j;
+        std::vector<NodeEntry>  nodes;
+        std::vector<EdgeEntry>  edges;
+        std::vector<NodeEntry>  goals;  // goal constraints, dur is not used
+        // length constraints of the agent whose goal is the cell, it can end its path there
+        // not earlier than the last of minGoalTimes and not later than the first of maxGoalTimes
+        std::vector<NodeEntry>  minGoalTimes, maxGoalTimes;
+    };
+
+    const CellConstraints* findCell(int i, int j) const;
+    CellConstraints& getCell(int i, int j);
+    int findSlot(int i, int j) const;
+    void rehash(int tableSize);
+
+    template<typename Entry>
+    static void insertEntry(std::vector<Entry> &entries, const Entry &entry);
+    template<typename Entry>
+    static void eraseEntry(std::vector<Entry> &entries, const Entry &entry);
+
+    std::vector<CellConstraints>    cells;
+    std::vector<int>                table;  // indices of cells, -1 for empty slots, size is a power of two
+    std::vector<Constraint>         positiveConstraints;
+};
 
 #endif // CONSTRAINTSSET_H
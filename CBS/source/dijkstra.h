@@ -2,8 +2,8 @@
 #define DIJKSTRA_H
 #include "isearch.h"
 
-template <typename NodeType = Node>
-class Dijkstra : public ISearch<NodeType>
+template <typename NodeType = Node, typename QueueType = SearchQueue<NodeType>>
+class Dijkstra : public ISearch<NodeType, QueueType>
 {
 public:
     virtual ~Dijkstra() = default;
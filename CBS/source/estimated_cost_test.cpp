@@ -0,0 +1,48 @@
+#include <iostream>
+#include "conflict_based_search.h"
+
+// Checks the cost estimate of EECBS learned from the errors of the expansions.
+// Usage: EstimatedCostTest, the exit code is the number of failed checks
+
+int failures = 0;
+
+void check(const std::string &name, int actual, int expected)
+{
+    if (actual != expected) {
+        std::cout << name << ": expected " << expected << ", got " << actual << std::endl;
+        ++failures;
+    }
+}
+
+int main()
+{
+    ConflictBasedSearch<> cbs;
+    CBSNode<> node;
+    node.G = 100;
+    node.hc = 3;
+
+    check("no errors learned", cbs.getEstimatedCost(node), 100);
+
+    cbs.costErrorSum = 2;
+    cbs.conflictsErrorSum = 1;
+    cbs.errorsCount = 2;
+    // every expansion adds 1 to the cost and removes half a conflict
+    check("errors below 1", cbs.getEstimatedCost(node), 106);
+
+    cbs.costErrorSum = 4;
+    cbs.conflictsErrorSum = 3;
+    // conflicts error 1.5 is clamped to 0.99, so every conflict costs 2 / 0.01
+    check("clamped conflicts error", cbs.getEstimatedCost(node), 700);
+
+    cbs.costErrorSum = -4;
+    check("negative cost error", cbs.getEstimatedCost(node), 100);
+
+    node.hc = 0;
+    cbs.costErrorSum = 4;
+    check("no conflicts", cbs.getEstimatedCost(node), 100);
+
+    if (failures == 0) {
+        std::cout << "All checks passed" << std::endl;
+    }
+    return failures;
+}
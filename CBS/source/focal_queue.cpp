@@ -0,0 +1,255 @@
+#include "focal_queue.h"
+#include "fs_node.h"
+#include "search_node.h"
+
+
+template<typename NodeType>
+FocalQueue<NodeType>::FocalQueue(bool (*_cmp)(const NodeType&, const NodeType&)) {
+    cmp = _cmp;
+}
+
+template<typename NodeType>
+bool FocalQueue<NodeType>::insert(const Map& map, NodeType node, bool withTime, bool, NodeType) {
+    // old node is always taken from the store, withOld and old are kept for compatibility with SearchQueue
+    int key = node.convolution(map.getMapWidth(), map.getMapHeight(), withTime);
+    auto it = slotByIndex.find(key);
+    if (it != slotByIndex.end()) {
+        int slot = it->second;
+        Slot &cur = slots[slot];
+        if (cur.hcPos != -1) {
+            if (!cmp(node, cur.node)) {
+                return false;
+            }
+            cur.node = node;
+            siftUpHC(cur.hcPos);
+            siftUpF(focalByF, cur.fPos);
+            siftDownF(focalByF, slots[slot].fPos);
+        } else {
+            if (node.F > cur.node.F || (node.F == cur.node.F && (node.conflictsCount > cur.node.conflictsCount ||
+                    (node.conflictsCount == cur.node.conflictsCount && node.g <= cur.node.g)))) {
+                return false;
+            }
+            cur.node = node;
+            siftUpF(openByF, cur.fPos);
+        }
+        return true;
+    }
+
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = slots.size();
+        slots.emplace_back();
+    }
+    slots[slot].node = node;
+    slots[slot].key = key;
+    slots[slot].hcPos = -1;
+    slotByIndex[key] = slot;
+    pushF(openByF, slot);
+    return true;
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::erase(const Map& map, NodeType node, bool withTime) {
+    auto it = slotByIndex.find(node.convolution(map.getMapWidth(), map.getMapHeight(), withTime));
+    if (it == slotByIndex.end()) {
+        return;
+    }
+    int slot = it->second;
+    slotByIndex.erase(it);
+    if (slots[slot].hcPos != -1) {
+        removeHC(slots[slot].hcPos);
+        removeF(focalByF, slots[slot].fPos);
+    } else {
+        removeF(openByF, slots[slot].fPos);
+    }
+    freeSlots.push_back(slot);
+}
+
+template<typename NodeType>
+NodeType FocalQueue<NodeType>::getByIndex(const Map& map, NodeType node, bool withTime) {
+    auto it = slotByIndex.find(node.convolution(map.getMapWidth(), map.getMapHeight(), withTime));
+    if (it == slotByIndex.end()) {
+        return NodeType(-1, -1);
+    }
+    return slots[it->second].node;
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::moveToFocal(double threshold) {
+    while (!openByF.empty() && slots[openByF[0]].node.F <= threshold) {
+        int slot = openByF[0];
+        removeF(openByF, 0);
+        pushF(focalByF, slot);
+        pushHC(slot);
+    }
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::moveFromFocal(double threshold) {
+    int kept = 0;
+    for (int pos = 0; pos < int(focalByHC.size()); ++pos) {
+        int slot = focalByHC[pos];
+        if (slots[slot].node.F > threshold) {
+            removeF(focalByF, slots[slot].fPos);
+            slots[slot].hcPos = -1;
+            pushF(openByF, slot);
+        } else {
+            focalByHC[kept] = slot;
+            slots[slot].hcPos = kept++;
+        }
+    }
+    focalByHC.resize(kept);
+    for (int pos = kept / 2 - 1; pos >= 0; --pos) {
+        siftDownHC(pos);
+    }
+}
+
+template<typename NodeType>
+NodeType FocalQueue<NodeType>::getFront() const {
+    return slots[focalByHC[0]].node;
+}
+
+template<typename NodeType>
+double FocalQueue<NodeType>::getMinF() const {
+    if (openByF.empty()) {
+        return getMinFocalF();
+    }
+    double minF = slots[openByF[0]].node.F;
+    return focalByF.empty() ? minF : std::min(minF, double(slots[focalByF[0]].node.F));
+}
+
+template<typename NodeType>
+double FocalQueue<NodeType>::getMinFocalF() const {
+    return focalByF.empty() ? CN_INFINITY : slots[focalByF[0]].node.F;
+}
+
+template<typename NodeType>
+bool FocalQueue<NodeType>::empty() const {
+    return slotByIndex.empty();
+}
+
+template<typename NodeType>
+int FocalQueue<NodeType>::size() const {
+    return slotByIndex.size();
+}
+
+template<typename NodeType>
+int FocalQueue<NodeType>::focalSize() const {
+    return focalByHC.size();
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::clear() {
+    slots.clear();
+    freeSlots.clear();
+    openByF.clear();
+    focalByF.clear();
+    focalByHC.clear();
+    slotByIndex.clear();
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::pushF(std::vector<int>& heap, int slot) {
+    heap.push_back(slot);
+    siftUpF(heap, heap.size() - 1);
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::removeF(std::vector<int>& heap, int pos) {
+    int last = heap.back();
+    heap.pop_back();
+    if (pos < int(heap.size())) {
+        heap[pos] = last;
+        slots[last].fPos = pos;
+        siftUpF(heap, pos);
+        siftDownF(heap, slots[last].fPos);
+    }
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::siftUpF(std::vector<int>& heap, int pos) {
+    int slot = heap[pos];
+    while (pos > 0 && lessF(slot, heap[(pos - 1) / 2])) {
+        heap[pos] = heap[(pos - 1) / 2];
+        slots[heap[pos]].fPos = pos;
+        pos = (pos - 1) / 2;
+    }
+    heap[pos] = slot;
+    slots[slot].fPos = pos;
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::siftDownF(std::vector<int>& heap, int pos) {
+    int slot = heap[pos];
+    while (2 * pos + 1 < int(heap.size())) {
+        int child = 2 * pos + 1;
+        if (child + 1 < int(heap.size()) && lessF(heap[child + 1], heap[child])) {
+            ++child;
+        }
+        if (!lessF(heap[child], slot)) {
+            break;
+        }
+        heap[pos] = heap[child];
+        slots[heap[pos]].fPos = pos;
+        pos = child;
+    }
+    heap[pos] = slot;
+    slots[slot].fPos = pos;
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::pushHC(int slot) {
+    focalByHC.push_back(slot);
+    siftUpHC(focalByHC.size() - 1);
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::removeHC(int pos) {
+    int slot = focalByHC[pos], last = focalByHC.back();
+    focalByHC.pop_back();
+    slots[slot].hcPos = -1;
+    if (pos < int(focalByHC.size())) {
+        focalByHC[pos] = last;
+        slots[last].hcPos = pos;
+        siftUpHC(pos);
+        siftDownHC(slots[last].hcPos);
+    }
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::siftUpHC(int pos) {
+    int slot = focalByHC[pos];
+    while (pos > 0 && lessHC(slot, focalByHC[(pos - 1) / 2])) {
+        focalByHC[pos] = focalByHC[(pos - 1) / 2];
+        slots[focalByHC[pos]].hcPos = pos;
+        pos = (pos - 1) / 2;
+    }
+    focalByHC[pos] = slot;
+    slots[slot].hcPos = pos;
+}
+
+template<typename NodeType>
+void FocalQueue<NodeType>::siftDownHC(int pos) {
+    int slot = focalByHC[pos];
+    while (2 * pos + 1 < int(focalByHC.size())) {
+        int child = 2 * pos + 1;
+        if (child + 1 < int(focalByHC.size()) && lessHC(focalByHC[child + 1], focalByHC[child])) {
+            ++child;
+        }
+        if (!lessHC(focalByHC[child], slot)) {
+            break;
+        }
+        focalByHC[pos] = focalByHC[child];
+        slots[focalByHC[pos]].hcPos = pos;
+        pos = child;
+    }
+    focalByHC[pos] = slot;
+    slots[slot].hcPos = pos;
+}
+
+template class FocalQueue<Node>;
+template class FocalQueue<FSNode>;
+template class FocalQueue<SearchNode>;
@@ -0,0 +1,65 @@
+#ifndef FOCALQUEUE_H
+#define FOCALQUEUE_H
+
+#include "node.h"
+#include "map.h"
+#include <vector>
+#include <unordered_map>
+
+// OPEN and FOCAL of the focal search in one store. Every node is kept once in a slot pool and
+// takes part in intrusive heaps of slot indices: nodes outside FOCAL are in a heap by F,
+// nodes of FOCAL are in a heap by F and in a heap by the focal comparator. Membership is given by heap positions,
+// so moving a node between OPEN and FOCAL never copies it and FOCAL grows incrementally when the bound on F rises.
+// A node outside FOCAL is replaced by a duplicate with less (F, conflictsCount, -g),
+// a node of FOCAL - by a duplicate that is less by the focal comparator, same as with two separate queues.
+template <typename NodeType = Node>
+class FocalQueue
+{
+public:
+    FocalQueue(bool (*cmp)(const NodeType&, const NodeType&) = [](const NodeType& lhs, const NodeType& rhs) {return lhs < rhs;});
+
+    bool insert(const Map& map, NodeType node, bool withTime,
+                bool withOld = false, NodeType old = NodeType(-1, -1));
+    void erase(const Map& map, NodeType node, bool withTime);
+    NodeType getByIndex(const Map& map, NodeType node, bool withTime);
+    void moveToFocal(double threshold);     // all nodes with F <= threshold join FOCAL
+    void moveFromFocal(double threshold);   // nodes of FOCAL with F > threshold return to OPEN
+    NodeType getFront() const;              // front of FOCAL
+    double getMinF() const;
+    double getMinFocalF() const;
+    bool empty() const;
+    int size() const;
+    int focalSize() const;
+    void clear();
+
+//private:
+    struct Slot
+    {
+        NodeType    node;
+        int         key;
+        int         fPos;   // position in openByF or focalByF
+        int         hcPos;  // position in focalByHC, -1 while the node is not in FOCAL
+    };
+
+    bool lessF(int lhs, int rhs) const { return slots[lhs].node.F < slots[rhs].node.F; }
+    bool lessHC(int lhs, int rhs) const { return cmp(slots[lhs].node, slots[rhs].node); }
+
+    void pushF(std::vector<int>& heap, int slot);
+    void removeF(std::vector<int>& heap, int pos);
+    void siftUpF(std::vector<int>& heap, int pos);
+    void siftDownF(std::vector<int>& heap, int pos);
+    void pushHC(int slot);
+    void removeHC(int pos);
+    void siftUpHC(int pos);
+    void siftDownHC(int pos);
+
+    std::vector<Slot>               slots;
+    std::vector<int>                freeSlots;
+    std::vector<int>                openByF;
+    std::vector<int>                focalByF;
+    std::vector<int>                focalByHC;
+    std::unordered_map<int, int>    slotByIndex;
+    bool (*cmp)(const NodeType&, const NodeType&);
+};
+
+#endif // FOCALQUEUE_H
@@ -1,26 +1,31 @@
 #include "focalsearch.h"
 
-template<typename NodeType>
-int FocalSearch<NodeType>::Time = 0;
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+int FocalSearch<NodeType, QueueType, FocalQueueType>::Time = 0;
 
-template<typename NodeType>
-FocalSearch<NodeType>::FocalSearch(bool WithTime, double FocalW, double HW, bool BT) :
-    Astar<NodeType>(WithTime, HW, BT) {
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+FocalSearch<NodeType, QueueType, FocalQueueType>::FocalSearch(bool WithTime, double FocalW, double HW, bool BT) :
+    Astar<NodeType, QueueType>(WithTime, HW, BT) {
     auto focalCmp = [](const NodeType &lhs, const NodeType &rhs) {
         return lhs.hc < rhs.hc || (lhs.hc == rhs.hc && lhs < rhs);
     };
-    focal = SearchQueue<NodeType>(focalCmp);
+    focal = FocalQueueType(focalCmp);
     focalW = FocalW;
+    // Astar is a virtual base and is initialized by the most derived class, which may inherit this constructor
+    this->withTime = WithTime;
+    this->breakingties = BT;
 }
 
-template<typename NodeType>
-bool FocalSearch<NodeType>::checkOpenEmpty() {
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+bool FocalSearch<NodeType, QueueType, FocalQueueType>::checkOpenEmpty() {
     return this->open.empty() && focal.empty();
 }
 
-template<typename NodeType>
-NodeType FocalSearch<NodeType>::getCur(const Map& map) {
-    if (!this->open.empty()) {
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+NodeType FocalSearch<NodeType, QueueType, FocalQueueType>::getCur(const Map& map) {
+    if constexpr (singleStore) {
+        focal.moveToFocal(focal.getMinF() * focalW);
+    } else if (!this->open.empty()) {
         double minF = this->open.getFront().F;
         if (!focalF.empty()) {
             minF = std::min(minF, *focalF.begin());
@@ -31,44 +36,64 @@ NodeType FocalSearch<NodeType>::getCur(const Map& map) {
     return cur;
 }
 
-template<typename NodeType>
-void FocalSearch<NodeType>::removeCur(const NodeType& cur, const Map& map) {
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+void FocalSearch<NodeType, QueueType, FocalQueueType>::removeCur(const NodeType& cur, const Map& map) {
     focal.erase(map, cur, this->withTime);
-    auto it = focalF.find(cur.F);
-    focalF.erase(focalF.find(cur.F));
+    if constexpr (!singleStore) {
+        focalF.erase(focalF.find(cur.F));
+    }
 }
 
-template<typename NodeType>
-bool FocalSearch<NodeType>::updateFocal(const NodeType& neigh, const Map& map) {
-    NodeType old = focal.getByIndex(map, neigh, this->withTime);
-    if (old.i != -1) {
-        if (focal.insert(map, neigh, this->withTime, true, old)) {
-            auto it = focalF.find(old.F);
-            focalF.erase(focalF.find(old.F));
-            focalF.insert(neigh.F);
-        }
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+bool FocalSearch<NodeType, QueueType, FocalQueueType>::updateFocal(const NodeType& neigh, const Map& map) {
+    if constexpr (singleStore) {
+        focal.insert(map, neigh, this->withTime);
         return true;
+    } else {
+        NodeType old = focal.getByIndex(map, neigh, this->withTime);
+        if (old.i != -1) {
+            if (focal.insert(map, neigh, this->withTime, true, old)) {
+                auto it = focalF.find(old.F);
+                focalF.erase(focalF.find(old.F));
+                focalF.insert(neigh.F);
+            }
+            return true;
+        }
+        return false;
     }
-    return false;
 }
 
-template<typename NodeType>
-double FocalSearch<NodeType>::getMinFocalF() {
-    if (focalF.empty()) {
-        return CN_INFINITY;
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+double FocalSearch<NodeType, QueueType, FocalQueueType>::getMinFocalF() {
+    if constexpr (singleStore) {
+        return focal.getMinFocalF();
+    } else {
+        if (focalF.empty()) {
+            return CN_INFINITY;
+        }
+        return *focalF.begin();
     }
-    return *focalF.begin();
 }
 
-template<typename NodeType>
-void FocalSearch<NodeType>::clearLists() {
-    ISearch<NodeType>::clearLists();
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+void FocalSearch<NodeType, QueueType, FocalQueueType>::clearLists() {
+    ISearch<NodeType, QueueType>::clearLists();
     focal.clear();
     focalF.clear();
 }
 
-template<typename NodeType>
-void FocalSearch<NodeType>::setHC(NodeType &neigh, const NodeType &cur,
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+void FocalSearch<NodeType, QueueType, FocalQueueType>::addStartNode(NodeType &node, const Map &map,
+                                                                   const ConflictAvoidanceTable &CAT) {
+    if constexpr (singleStore) {
+        focal.insert(map, node, this->withTime);
+    } else {
+        ISearch<NodeType, QueueType>::addStartNode(node, map, CAT);
+    }
+}
+
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+void FocalSearch<NodeType, QueueType, FocalQueueType>::setHC(NodeType &neigh, const NodeType &cur,
                                   const ConflictAvoidanceTable &CAT, bool isGoal) {
     neigh.hc = cur.hc + neigh.conflictsCount;
     if (isGoal) {
@@ -76,20 +101,26 @@ void FocalSearch<NodeType>::setHC(NodeType &neigh, const NodeType &cur,
     }
 }
 
-template<typename NodeType>
-void FocalSearch<NodeType>::addFutureConflicts(NodeType &neigh, const ConflictAvoidanceTable &CAT) {
-    neigh.futureConflictsCount = CAT.getFutureConflictsCount(neigh, neigh.g);
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+void FocalSearch<NodeType, QueueType, FocalQueueType>::addFutureConflicts(NodeType &neigh, const ConflictAvoidanceTable &CAT) {
+    neigh.futureConflictsCount = CAT.getFutureConflictsCount(neigh.i, neigh.j, neigh.g);
     neigh.hc += neigh.futureConflictsCount;
 }
 
-template<typename NodeType>
-void FocalSearch<NodeType>::updateFocalW(double newFocalW, const Map& map) {
+template<typename NodeType, typename QueueType, typename FocalQueueType>
+void FocalSearch<NodeType, QueueType, FocalQueueType>::updateFocalW(double newFocalW, const Map& map) {
     focalW = newFocalW;
-    if (focal.empty()) {
-        return;
+    if constexpr (singleStore) {
+        focal.moveFromFocal(focal.getMinFocalF() * focalW);
+    } else if (!focal.empty()) {
+        double minF = *focalF.begin();
+        this->focal.moveByLowerBound(this->open, minF * focalW, map, focalF, this->withTime);
     }
-    double minF = *focalF.begin();
-    this->focal.moveByLowerBound(this->open, minF * focalW, map, focalF, this->withTime);
 }
 
 template class FocalSearch<FSNode>;
+template class FocalSearch<FSNode, IndexedHeapQueue<FSNode>>;
+template class FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>;
+template class FocalSearch<SearchNode, BucketQueue<SearchNode>, IndexedHeapQueue<SearchNode>>;
+template class FocalSearch<FSNode, FocalQueue<FSNode>>;
+template class FocalSearch<SearchNode, FocalQueue<SearchNode>>;
@@ -3,9 +3,11 @@
 
 #include "astar.h"
 #include "fs_node.h"
+#include "focal_queue.h"
+#include <type_traits>
 
-template <typename NodeType = FSNode>
-class FocalSearch : virtual public Astar<NodeType>
+template <typename NodeType = FSNode, typename QueueType = SearchQueue<NodeType>, typename FocalQueueType = QueueType>
+class FocalSearch : virtual public Astar<NodeType, QueueType>
 {
 public:
     FocalSearch(bool WithTime = false, double FocalW = 1.0, double HW = 1.0, bool BT = true);
@@ -31,10 +33,14 @@ protected:
     virtual int getFocalSize() override { return focal.size(); }
     virtual void subtractFutureConflicts(NodeType &node) override { node.hc -= node.futureConflictsCount; }
     virtual void addFutureConflicts(NodeType &neigh, const ConflictAvoidanceTable &CAT);
+    virtual void addStartNode(NodeType &node, const Map &map, const ConflictAvoidanceTable &CAT) override;
 
     virtual void addTime(int time) { Time += time; };
 
-    SearchQueue<NodeType> focal;
+    // FOCAL is ordered by hc first, so it may need a different queue than OPEN.
+    // FocalQueue keeps both OPEN and FOCAL, then open stays empty and focalF is not used
+    static constexpr bool singleStore = std::is_same<FocalQueueType, FocalQueue<NodeType>>::value;
+    FocalQueueType focal;
     std::multiset<double> focalF;
     double focalW;
 
@@ -42,6 +42,12 @@
         #define CNS_TAG_CARD_CONF   "with_card_conf"
         #define CNS_TAG_BYPASSING   "with_bypassing"
         #define CNS_TAG_WITH_MH     "with_matching_h"
+        #define CNS_TAG_WITH_DG     "with_dg_h"
+        #define CNS_TAG_WITH_WDG    "with_wdg_h"
+        #define CNS_TAG_WITH_CR     "with_corridor_reasoning"
+        #define CNS_TAG_WITH_RR     "with_rectangle_reasoning"
+        #define CNS_TAG_WITH_TR     "with_target_reasoning"
+        #define CNS_TAG_MERGE_TH    "merge_threshold"
         #define CNS_TAG_WITH_DS     "with_disjoint_splitting"
         #define CNS_TAG_FOCAL_W     "focal_w"
         #define CNS_TAG_WEIGHT      "weight"
@@ -56,6 +62,7 @@
             #define CNS_TAG_MAX     "max"
         #define CNS_TAG_AGENTS_STEP "agents_step"
         #define CNS_TAG_FIRST_TASK  "first_task"
+        #define CNS_TAG_H_CACHE     "heuristic_cache"
 
     #define CNS_TAG_LOG             "log"
         #define CNS_TAG_MAPFN       "mapfilename"
@@ -122,6 +129,7 @@
 //Search Parameters
     #define CNS_ST_CBS                  "cbs"
     #define CNS_ST_ECBS                 "ecbs"
+    #define CNS_ST_EECBS                "eecbs"
     #define CNS_ST_ECBS_CT              "ecbs-ct"
     
     #define CN_ST_CBS                   0
@@ -131,10 +139,12 @@
 
         #define CNS_SP_ST_ASTAR         "astar"
         #define CNS_SP_ST_FS            "focal_search"
+        #define CNS_SP_ST_SIPP          "sipp"
         
         #define CN_SP_ST_ASTAR          0
         #define CN_SP_ST_TIME_ASTAR     1
         #define CN_SP_ST_FS             2
+        #define CN_SP_ST_SIPP           3
         
 
     #define CN_SP_AD 1 //AllowDiagonal
@@ -0,0 +1,200 @@
+#include "indexed_heap_queue.h"
+#include "bucket_queue.h"
+#include "fs_node.h"
+#include "search_node.h"
+
+
+template<typename NodeType>
+IndexedHeapQueue<NodeType>::IndexedHeapQueue(bool (*_cmp)(const NodeType&, const NodeType&)) {
+    cmp = _cmp;
+}
+
+template<typename NodeType>
+bool IndexedHeapQueue<NodeType>::insert(const Map& map, NodeType node, bool withTime, bool, NodeType) {
+    // old node is always taken from the store, withOld and old are kept for compatibility with SearchQueue
+    int key = node.convolution(map.getMapWidth(), map.getMapHeight(), withTime);
+    auto it = slotByIndex.find(key);
+    if (it != slotByIndex.end()) {
+        int slot = it->second;
+        if (!cmp(node, nodes[slot])) {
+            return false;
+        }
+        nodes[slot] = node;
+        siftUp(heapPos[slot]);
+        return true;
+    }
+
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        nodes[slot] = node;
+        keys[slot] = key;
+    } else {
+        slot = nodes.size();
+        nodes.push_back(node);
+        keys.push_back(key);
+        heapPos.push_back(-1);
+    }
+    slotByIndex[key] = slot;
+    heap.push_back(slot);
+    heapPos[slot] = heap.size() - 1;
+    siftUp(heap.size() - 1);
+    return true;
+}
+
+template<typename NodeType>
+void IndexedHeapQueue<NodeType>::erase(const Map& map, NodeType node, bool withTime) {
+    auto it = slotByIndex.find(node.convolution(map.getMapWidth(), map.getMapHeight(), withTime));
+    if (it == slotByIndex.end()) {
+        return;
+    }
+    int slot = it->second;
+    removeFromHeap(heapPos[slot]);
+    releaseSlot(slot);
+}
+
+template<typename NodeType>
+NodeType IndexedHeapQueue<NodeType>::getByIndex(const Map& map, NodeType node, bool withTime) {
+    auto it = slotByIndex.find(node.convolution(map.getMapWidth(), map.getMapHeight(), withTime));
+    if (it == slotByIndex.end()) {
+        return NodeType(-1, -1);
+    }
+    return nodes[it->second];
+}
+
+template<typename NodeType>
+template<typename OtherQueue>
+void IndexedHeapQueue<NodeType>::moveByUpperBound(OtherQueue& other, double threshold,
+                                                  const Map& map, std::multiset<double>& otherF, bool withTime) {
+    while (!heap.empty() && nodes[heap[0]].F <= threshold) {
+        int slot = heap[0];
+        other.insert(map, nodes[slot], withTime);
+        otherF.insert(nodes[slot].F);
+        removeFromHeap(0);
+        releaseSlot(slot);
+    }
+}
+
+template<typename NodeType>
+template<typename OtherQueue>
+void IndexedHeapQueue<NodeType>::moveByLowerBound(OtherQueue& other, double threshold,
+                                                  const Map& map, std::multiset<double>& FValues, bool withTime) {
+    int kept = 0;
+    for (int pos = 0; pos < int(heap.size()); ++pos) {
+        int slot = heap[pos];
+        if (nodes[slot].F > threshold) {
+            other.insert(map, nodes[slot], withTime);
+            FValues.erase(nodes[slot].F);
+            releaseSlot(slot);
+        } else {
+            setHeapPos(kept++, slot);
+        }
+    }
+    if (kept == int(heap.size())) {
+        return;
+    }
+    heap.resize(kept);
+    for (int pos = (kept - 2) / arity; pos >= 0 && kept > 1; --pos) {
+        siftDown(pos);
+    }
+}
+
+template<typename NodeType>
+NodeType IndexedHeapQueue<NodeType>::getFront() const {
+    return nodes[heap[0]];
+}
+
+template<typename NodeType>
+bool IndexedHeapQueue<NodeType>::empty() const {
+    return heap.empty();
+}
+
+template<typename NodeType>
+int IndexedHeapQueue<NodeType>::size() const {
+    return heap.size();
+}
+
+template<typename NodeType>
+void IndexedHeapQueue<NodeType>::clear() {
+    nodes.clear();
+    keys.clear();
+    heapPos.clear();
+    freeSlots.clear();
+    heap.clear();
+    slotByIndex.clear();
+}
+
+template<typename NodeType>
+void IndexedHeapQueue<NodeType>::setHeapPos(int pos, int slot) {
+    heap[pos] = slot;
+    heapPos[slot] = pos;
+}
+
+template<typename NodeType>
+void IndexedHeapQueue<NodeType>::siftUp(int pos) {
+    int slot = heap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / arity;
+        if (!cmp(nodes[slot], nodes[heap[parent]])) {
+            break;
+        }
+        setHeapPos(pos, heap[parent]);
+        pos = parent;
+    }
+    setHeapPos(pos, slot);
+}
+
+template<typename NodeType>
+void IndexedHeapQueue<NodeType>::siftDown(int pos) {
+    int slot = heap[pos];
+    int n = heap.size();
+    while (true) {
+        int first = pos * arity + 1;
+        if (first >= n) {
+            break;
+        }
+        int best = first;
+        for (int child = first + 1; child < std::min(first + arity, n); ++child) {
+            if (cmp(nodes[heap[child]], nodes[heap[best]])) {
+                best = child;
+            }
+        }
+        if (!cmp(nodes[heap[best]], nodes[slot])) {
+            break;
+        }
+        setHeapPos(pos, heap[best]);
+        pos = best;
+    }
+    setHeapPos(pos, slot);
+}
+
+template<typename NodeType>
+void IndexedHeapQueue<NodeType>::removeFromHeap(int pos) {
+    int last = heap.back();
+    heap.pop_back();
+    if (pos < int(heap.size())) {
+        setHeapPos(pos, last);
+        siftUp(pos);
+        siftDown(heapPos[last]);
+    }
+}
+
+template<typename NodeType>
+void IndexedHeapQueue<NodeType>::releaseSlot(int slot) {
+    slotByIndex.erase(keys[slot]);
+    heapPos[slot] = -1;
+    freeSlots.push_back(slot);
+}
+
+template class IndexedHeapQueue<Node>;
+template class IndexedHeapQueue<FSNode>;
+template class IndexedHeapQueue<SearchNode>;
+template void IndexedHeapQueue<FSNode>::moveByUpperBound(IndexedHeapQueue<FSNode>&, double,
+                                                         const Map&, std::multiset<double>&, bool);
+template void IndexedHeapQueue<FSNode>::moveByLowerBound(IndexedHeapQueue<FSNode>&, double,
+                                                         const Map&, std::multiset<double>&, bool);
+template void IndexedHeapQueue<FSNode>::moveByLowerBound(BucketQueue<FSNode>&, double,
+                                                         const Map&, std::multiset<double>&, bool);
+template void IndexedHeapQueue<SearchNode>::moveByLowerBound(BucketQueue<SearchNode>&, double,
+                                                             const Map&, std::multiset<double>&, bool);
@@ -0,0 +1,52 @@
+#ifndef INDEXEDHEAPQUEUE_H
+#define INDEXEDHEAPQUEUE_H
+
+#include "node.h"
+#include "map.h"
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+// Drop-in replacement for SearchQueue: d-ary heap of slot indices over a contiguous node store.
+// Every node is stored once, an improved node is updated in place and sifted up (decrease-key).
+template <typename NodeType = Node>
+class IndexedHeapQueue
+{
+public:
+    IndexedHeapQueue(bool (*cmp)(const NodeType&, const NodeType&) = [](const NodeType& lhs, const NodeType& rhs) {return lhs < rhs;});
+
+    bool insert(const Map& map, NodeType node, bool withTime,
+                bool withOld = false, NodeType old = NodeType(-1, -1));
+    void erase(const Map& map, NodeType node, bool withTime);
+    template<typename OtherQueue>
+    void moveByUpperBound(OtherQueue& other, double threshold,
+        const Map& map, std::multiset<double>& otherF, bool withTime = false);
+    template<typename OtherQueue>
+    void moveByLowerBound(OtherQueue& other, double threshold,
+        const Map& map, std::multiset<double>& FValues, bool withTime = false);
+    NodeType getByIndex(const Map& map, NodeType node, bool withTime);
+    NodeType getFront() const;
+    bool empty() const;
+    int size() const;
+    void clear();
+
+//private:
+    static const int arity = 2;
+
+    void siftUp(int pos);
+    void siftDown(int pos);
+    void setHeapPos(int pos, int slot);
+    void removeFromHeap(int pos);
+    void releaseSlot(int slot);
+
+    std::vector<NodeType> nodes;
+    std::vector<int> keys;
+    std::vector<int> heapPos;
+    std::vector<int> freeSlots;
+    std::vector<int> heap;
+    std::unordered_map<int, int> slotByIndex;
+    bool (*cmp)(const NodeType&, const NodeType&);
+};
+
+#endif // INDEXEDHEAPQUEUE_H
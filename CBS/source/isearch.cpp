@@ -1,23 +1,41 @@
 #include "isearch.h"
 #include "fs_node.h"
+#include "search_engine.h"
+#include "focalsearch.h"
+#include "sipp.h"
 
 
-template<typename NodeType>
-ISearch<NodeType>::ISearch(bool WithTime)
+template<typename NodeType, typename QueueType>
+ISearch<NodeType, QueueType>::ISearch(bool WithTime)
 {
     hweight = 1;
     breakingties = CN_SP_BT_GMAX;
     withTime = WithTime;
 }
 
-template<typename NodeType>
-int ISearch<NodeType>::T = 0;
+template<typename NodeType, typename QueueType>
+int ISearch<NodeType, QueueType>::T = 0;
 
-template<typename NodeType>
-int ISearch<NodeType>::P = 0;
+template<typename NodeType, typename QueueType>
+int ISearch<NodeType, QueueType>::P = 0;
 
-template<typename NodeType>
-SearchResult ISearch<NodeType>::startSearch(const Map &map, const AgentSet &agentSet,
+template<typename NodeType, typename QueueType>
+SearchResult ISearch<NodeType, QueueType>::startSearch(const Map &map, const AgentSet &agentSet,
+                                  int start_i, int start_j, int goal_i, int goal_j,
+                                  bool (*isGoal)(const Node&, const Node&, const Map&, const AgentSet&),
+                                  bool freshStart, bool returnPath, int startTime, int goalTime, int maxTime,
+                                  const std::unordered_set<Node> &occupiedNodes,
+                                  const ConstraintsSet &constraints,
+                                  bool withCAT, const ConflictAvoidanceTable &CAT,
+                                  std::chrono::steady_clock::time_point globalBegin, int globalTimeLimit)
+{
+    return runSearch(*this, map, agentSet, start_i, start_j, goal_i, goal_j, isGoal, freshStart, returnPath,
+                     startTime, goalTime, maxTime, occupiedNodes, constraints, withCAT, CAT, globalBegin, globalTimeLimit);
+}
+
+template<typename NodeType, typename QueueType>
+template<typename Self>
+SearchResult ISearch<NodeType, QueueType>::runSearch(Self &self, const Map &map, const AgentSet &agentSet,
                                   int start_i, int start_j, int goal_i, int goal_j,
                                   bool (*isGoal)(const Node&, const Node&, const Map&, const AgentSet&),
                                   bool freshStart, bool returnPath, int startTime, int goalTime, int maxTime,
@@ -37,24 +55,47 @@ SearchResult ISearch<NodeType>::startSearch(const Map &map, const AgentSet &agen
         agentId = agentSet.getAgentId(start_i, start_j);
     }
 
-    if (withCAT && freshStart) {
-        open = SearchQueue<NodeType>([](const NodeType &lhs, const NodeType &rhs) {
-            return std::tuple<double, int, int, int, int>(lhs.F, lhs.conflictsCount, -lhs.g, lhs.i, lhs.j) <
-                    std::tuple<double, int, int, int, int>(rhs.F, rhs.conflictsCount, -rhs.g, rhs.i, rhs.j);
-        });
+    // length constraints bound the time the path ends in the goal, the agent waits there if it comes earlier
+    int minGoalTime = 0, maxGoalTime = CN_INFINITY;
+    if (goalTime == -1) {
+        minGoalTime = constraints.getMinGoalTime(goal_i, goal_j, agentId);
+        maxGoalTime = constraints.getMaxGoalTime(goal_i, goal_j, agentId);
+        if (maxGoalTime != CN_INFINITY && (maxTime == -1 || maxGoalTime < maxTime)) {
+            maxTime = maxGoalTime;
+        }
+    }
+
+    // a goal constraint closes its cell for good and may cut the agent off its goal, then the search would
+    // go on forever. After the last constraint the agent can wait anywhere, so in this case a cell is not
+    // expanded again at a later time. Without goal constraints later arrivals are kept, they may have fewer
+    // conflicts with the CAT. A path that has to end at goalTime may need to wait or come back after it
+    int staticTime = withTime && self.canStay() && goalTime == -1 && constraints.hasGoalConstraints() ?
+                     constraints.getLastConstraintTime() : -1;
+    std::vector<int> staticExpansionTimes;
+
+    // BucketQueue already keeps this order and takes no comparator
+    if constexpr (std::is_constructible<QueueType, bool (*)(const NodeType&, const NodeType&)>::value) {
+        if (withCAT && freshStart) {
+            open = QueueType([](const NodeType &lhs, const NodeType &rhs) {
+                return std::tuple<double, int, int, int, int>(lhs.F, lhs.conflictsCount, -lhs.g, lhs.i, lhs.j) <
+                        std::tuple<double, int, int, int, int>(rhs.F, rhs.conflictsCount, -rhs.g, rhs.i, rhs.j);
+            });
+        }
     }
 
     if (freshStart) {
-        clearLists();
+        self.clearLists();
         sresult.numberofsteps = 0;
         cur = NodeType(start_i, start_j, nullptr, startTime,
-                 computeHFromCellToCell(start_i, start_j, goal_i, goal_j));
-        setEndTime(cur, start_i, start_j, startTime, agentId, constraints);
-        addStartNode(cur, map, CAT);
-        addSuboptimalNode(cur, map, CAT);
+                 self.computeHFromCellToCell(start_i, start_j, goal_i, goal_j));
+        self.setEndTime(cur, start_i, start_j, startTime, agentId, constraints);
+        self.addStartNode(cur, map, CAT);
+        self.addSuboptimalNode(cur, map, CAT);
     }
 
-    while(!checkOpenEmpty()) {
+    // reused by every expansion, findSuccessors clears it, so the buffer of SIPP allocates only when it grows
+    SuccessorBuffer<NodeType> successors;
+    while(!self.checkOpenEmpty()) {
         ++sresult.numberofsteps;
 
         if (sresult.numberofsteps % 100000 == 0) {
@@ -73,37 +114,48 @@ SearchResult ISearch<NodeType>::startSearch(const Map &map, const AgentSet &agen
             }
         }
 
-        cur = getCur(map);
+        cur = self.getCur(map);
 
         bool goalNode = false;
         if ((isGoal != nullptr && isGoal(NodeType(start_i, start_j), cur, map, agentSet)) ||
             (isGoal == nullptr && cur.i == goal_i && cur.j == goal_j))
         {
             goalNode = true;
-            if (!constraints.hasFutureConstraint(cur.i, cur.j, cur.g, agentId) &&
-                checkGoal(cur, goalTime, agentId, constraints))
+            if (cur.g <= maxGoalTime && !constraints.hasFutureConstraint(cur.i, cur.j, cur.g, agentId) &&
+                self.checkGoal(cur, goalTime, agentId, constraints))
             {
                 sresult.pathfound = true;
                 break;
             }
         }
 
-        removeCur(cur, map);
+        self.removeCur(cur, map);
 
         if (goalNode) {
-            subtractFutureConflicts(cur);
+            self.subtractFutureConflicts(cur);
+        }
+
+        if (staticTime != -1 && cur.g > staticTime) {
+            if (staticExpansionTimes.empty()) {
+                staticExpansionTimes.resize(map.getMapHeight() * map.getMapWidth(), CN_INFINITY);
+            }
+            int &expansionTime = staticExpansionTimes[cur.i * map.getMapWidth() + cur.j];
+            if (expansionTime <= cur.g) {
+                continue;
+            }
+            expansionTime = cur.g;
         }
 
-        close[cur.convolution(map.getMapWidth(), map.getMapHeight(), withTime)] = cur;
-        NodeType *curPtr = &(close.find(cur.convolution(map.getMapWidth(), map.getMapHeight(), withTime))->second);
+        int curIndex = close.insert(map, cur, withTime);
+        NodeType *curPtr = &close.getNode(curIndex);
 
         if (maxTime == -1 || cur.g < maxTime) {
-            std::list<NodeType> successors = findSuccessors(cur, map, goal_i, goal_j, agentId, occupiedNodes,
-                                                        constraints, withCAT, CAT);
+            self.findSuccessors(cur, map, successors, goal_i, goal_j, agentId, occupiedNodes,
+                           constraints, withCAT, CAT);
             for (auto neigh : successors) {
-                if (close.find(neigh.convolution(map.getMapWidth(), map.getMapHeight(), withTime)) == close.end()) {
-                    neigh.parent = curPtr;
-                    if (!updateFocal(neigh, map)) {
+                if (!close.contains(map, neigh, withTime)) {
+                    setParent(neigh, curPtr, curIndex);
+                    if (!self.updateFocal(neigh, map)) {
                         open.insert(map, neigh, withTime);
                     }
                 }
@@ -115,19 +167,24 @@ SearchResult ISearch<NodeType>::startSearch(const Map &map, const AgentSet &agen
     int elapsedMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
 
     sresult.time = static_cast<double>(elapsedMilliseconds) / 1000;
-    sresult.nodescreated = open.size() + close.size() + getFocalSize();
+    sresult.nodescreated = open.size() + close.size() + self.getFocalSize();
     sresult.nodesexpanded = close.size();
 
 
     if (sresult.pathfound) {
-        sresult.pathlength = cur.g;
-        sresult.minF = std::min(double(cur.F), getMinFocalF());
+        sresult.pathlength = std::max(cur.g, minGoalTime);
+        sresult.minF = std::min(double(cur.F), self.getMinFocalF());
         sresult.lastNode = cur;
         if (returnPath) {
             lppath.clear();
             hppath.clear();
-            makePrimaryPath(cur, goalTime == -1 ? -1 : goalTime + 1);
-            makeSecondaryPath(map);
+            int endTime = goalTime != -1 ? goalTime + 1 : (cur.g < minGoalTime ? minGoalTime + 1 : -1);
+            if constexpr (std::is_base_of<Node, NodeType>::value) {
+                self.makePrimaryPath(cur, endTime);
+            } else {
+                makePrimaryPathFromPool(cur, endTime);
+            }
+            self.makeSecondaryPath(map);
             sresult.hppath = &hppath; //Here is a constant pointer
             sresult.lppath = &lppath;
         }
@@ -135,79 +192,103 @@ SearchResult ISearch<NodeType>::startSearch(const Map &map, const AgentSet &agen
     return sresult;
 }
 
-template<typename NodeType>
-std::list<NodeType> ISearch<NodeType>::findSuccessors(const NodeType &curNode, const Map &map,
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::findSuccessors(const NodeType &curNode, const Map &map,
+                                        SuccessorBuffer<NodeType> &successors,
+                                        int goal_i, int goal_j, int agentId,
+                                        const std::unordered_set<Node> &occupiedNodes,
+                                        const ConstraintsSet &constraints,
+                                        bool withCAT, const ConflictAvoidanceTable &CAT)
+{
+    generateSuccessors(*this, curNode, map, successors, goal_i, goal_j, agentId, occupiedNodes, constraints, withCAT, CAT);
+}
+
+template<typename NodeType, typename QueueType>
+template<typename Self>
+void ISearch<NodeType, QueueType>::generateSuccessors(Self &self, const NodeType &curNode, const Map &map,
+                                        SuccessorBuffer<NodeType> &successors,
                                         int goal_i, int goal_j, int agentId,
                                         const std::unordered_set<Node> &occupiedNodes,
                                         const ConstraintsSet &constraints,
                                         bool withCAT, const ConflictAvoidanceTable &CAT)
 {
-    std::list<NodeType> successors;
+    successors.clear();
     for (int di = -1; di <= 1; ++di) {
         for (int dj = -1; dj <= 1; ++dj) {
             int newi = curNode.i + di, newj = curNode.j + dj;
-            if ((di == 0 || dj == 0) && (canStay() || di != 0 || dj != 0) && map.CellOnGrid(newi, newj) &&
+            if ((di == 0 || dj == 0) && (self.canStay() || di != 0 || dj != 0) && map.CellOnGrid(newi, newj) &&
                     map.CellIsTraversable(newi, newj, occupiedNodes)) {
-                int newh = computeHFromCellToCell(newi, newj, goal_i, goal_j);
+                int newh = self.computeHFromCellToCell(newi, newj, goal_i, goal_j);
                 NodeType neigh(newi, newj, nullptr, curNode.g + 1, newh);
-                neigh.conflictsCount = CAT.getAgentsCount(neigh, curNode);
-                createSuccessorsFromNode(curNode, neigh, successors, agentId, constraints, CAT,
-                                         neigh.i == goal_i && neigh.j == goal_j);
+                neigh.conflictsCount = CAT.getAgentsCount(neigh.i, neigh.j, neigh.g, curNode.i, curNode.j);
+                self.createSuccessorsFromNode(curNode, neigh, successors, agentId, constraints, CAT,
+                                              neigh.i == goal_i && neigh.j == goal_j);
             }
         }
     }
-    return successors;
 }
 
-template<typename NodeType>
-void ISearch<NodeType>::clearLists() {
+template<typename NodeType, typename QueueType>
+std::list<NodeType> ISearch<NodeType, QueueType>::findSuccessors(const NodeType &curNode, const Map &map,
+                                        int goal_i, int goal_j, int agentId,
+                                        const std::unordered_set<Node> &occupiedNodes,
+                                        const ConstraintsSet &constraints,
+                                        bool withCAT, const ConflictAvoidanceTable &CAT)
+{
+    SuccessorBuffer<NodeType> successors;
+    findSuccessors(curNode, map, successors, goal_i, goal_j, agentId, occupiedNodes, constraints, withCAT, CAT);
+    return std::list<NodeType>(successors.begin(), successors.end());
+}
+
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::clearLists() {
     open.clear();
     close.clear();
 }
 
-template<typename NodeType>
-void ISearch<NodeType>::addStartNode(NodeType &node, const Map &map, const ConflictAvoidanceTable &CAT) {
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::addStartNode(NodeType &node, const Map &map, const ConflictAvoidanceTable &CAT) {
     open.insert(map, node, withTime);
 }
 
-template<typename NodeType>
-bool ISearch<NodeType>::checkOpenEmpty() {
+template<typename NodeType, typename QueueType>
+bool ISearch<NodeType, QueueType>::checkOpenEmpty() {
     return open.empty();
 }
 
-template<typename NodeType>
-NodeType ISearch<NodeType>::getCur(const Map& map) {
+template<typename NodeType, typename QueueType>
+NodeType ISearch<NodeType, QueueType>::getCur(const Map& map) {
     NodeType cur = open.getFront();
     return cur;
 }
 
-template<typename NodeType>
-void ISearch<NodeType>::removeCur(const NodeType& cur, const Map& map) {
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::removeCur(const NodeType& cur, const Map& map) {
     open.erase(map, cur, withTime);
 }
 
-template<typename NodeType>
-bool ISearch<NodeType>::updateFocal(const NodeType& neigh, const Map& map) {
+template<typename NodeType, typename QueueType>
+bool ISearch<NodeType, QueueType>::updateFocal(const NodeType& neigh, const Map& map) {
     return false;
 }
 
-template<typename NodeType>
-double ISearch<NodeType>::getMinFocalF() {
+template<typename NodeType, typename QueueType>
+double ISearch<NodeType, QueueType>::getMinFocalF() {
     return CN_INFINITY;
 }
 
-template<typename NodeType>
-void ISearch<NodeType>::setEndTime(NodeType& node, int start_i, int start_j, int startTime, int agentId, const ConstraintsSet &constraints) {
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::setEndTime(NodeType& node, int start_i, int start_j, int startTime, int agentId, const ConstraintsSet &constraints) {
     return;
 }
 
-template<typename NodeType>
-bool ISearch<NodeType>::checkGoal(const NodeType &cur, int goalTime, int agentId, const ConstraintsSet &constraints) {
+template<typename NodeType, typename QueueType>
+bool ISearch<NodeType, QueueType>::checkGoal(const NodeType &cur, int goalTime, int agentId, const ConstraintsSet &constraints) {
     return goalTime == -1 || cur.g == goalTime;
 }
 
-template<typename NodeType>
-void ISearch<NodeType>::createSuccessorsFromNode(const NodeType &cur, NodeType &neigh, std::list<NodeType> &successors,
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::createSuccessorsFromNode(const NodeType &cur, NodeType &neigh, SuccessorBuffer<NodeType> &successors,
                                        int agentId, const ConstraintsSet &constraints,
                                        const ConflictAvoidanceTable &CAT, bool isGoal) {
     if (!constraints.hasNodeConstraint(neigh.i, neigh.j, neigh.g, agentId) &&
@@ -217,8 +298,8 @@ void ISearch<NodeType>::createSuccessorsFromNode(const NodeType &cur, NodeType &
     }
 }
 
-template<typename NodeType>
-void ISearch<NodeType>::makePrimaryPath(Node &curNode, int endTime)
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::makePrimaryPath(Node &curNode, int endTime)
 {
     if (withTime && endTime != -1) {
         int startTime = curNode.g;
@@ -232,8 +313,30 @@ void ISearch<NodeType>::makePrimaryPath(Node &curNode, int endTime)
     }
 }
 
-template<typename NodeType>
-void ISearch<NodeType>::makeSecondaryPath(const Map &map)
+template<typename NodeType, typename QueueType>
+template<typename PoolNode>
+void ISearch<NodeType, QueueType>::makePrimaryPathFromPool(const PoolNode &curNode, int endTime)
+{
+    PoolNode cur = curNode;
+    while (true) {
+        Node node = cur;
+        if (withTime && endTime != -1) {
+            for (node.g = endTime - 1; node.g > cur.g; --node.g) {
+                lppath.push_front(node);
+            }
+            node.g = cur.g;
+        }
+        lppath.push_front(node);
+        if (cur.parent == -1) {
+            break;
+        }
+        endTime = cur.g;
+        cur = close.getNode(cur.parent);
+    }
+}
+
+template<typename NodeType, typename QueueType>
+void ISearch<NodeType, QueueType>::makeSecondaryPath(const Map &map)
 {
     auto it = lppath.begin();
     hppath.push_back(*it);
@@ -252,3 +355,63 @@ void ISearch<NodeType>::makeSecondaryPath(const Map &map)
 
 template class ISearch<Node>;
 template class ISearch<FSNode>;
+template class ISearch<Node, IndexedHeapQueue<Node>>;
+template class ISearch<FSNode, IndexedHeapQueue<FSNode>>;
+template class ISearch<Node, BucketQueue<Node>>;
+template class ISearch<FSNode, BucketQueue<FSNode>>;
+template class ISearch<SearchNode, BucketQueue<SearchNode>>;
+template class ISearch<FSNode, FocalQueue<FSNode>>;
+template class ISearch<SearchNode, FocalQueue<SearchNode>>;
+template class ISearch<SIPPNode, BucketQueue<SIPPNode>>;
+
+template SearchResult ISearch<Node, BucketQueue<Node>>::runSearch(SearchEngine<Astar<Node, BucketQueue<Node>>>&,
+    const Map&, const AgentSet&, int, int, int, int, bool (*)(const Node&, const Node&, const Map&, const AgentSet&),
+    bool, bool, int, int, int, const std::unordered_set<Node>&, const ConstraintsSet&, bool, const ConflictAvoidanceTable&,
+    std::chrono::steady_clock::time_point, int);
+template void ISearch<Node, BucketQueue<Node>>::generateSuccessors(SearchEngine<Astar<Node, BucketQueue<Node>>>&,
+    const Node&, const Map&, SuccessorBuffer<Node>&, int, int, int, const std::unordered_set<Node>&,
+    const ConstraintsSet&, bool, const ConflictAvoidanceTable&);
+template SearchResult ISearch<FSNode, BucketQueue<FSNode>>::runSearch(
+    SearchEngine<FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>>&,
+    const Map&, const AgentSet&, int, int, int, int, bool (*)(const Node&, const Node&, const Map&, const AgentSet&),
+    bool, bool, int, int, int, const std::unordered_set<Node>&, const ConstraintsSet&, bool, const ConflictAvoidanceTable&,
+    std::chrono::steady_clock::time_point, int);
+template void ISearch<FSNode, BucketQueue<FSNode>>::generateSuccessors(
+    SearchEngine<FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>>&,
+    const FSNode&, const Map&, SuccessorBuffer<FSNode>&, int, int, int, const std::unordered_set<Node>&,
+    const ConstraintsSet&, bool, const ConflictAvoidanceTable&);
+
+template SearchResult ISearch<SearchNode, BucketQueue<SearchNode>>::runSearch(
+    SearchEngine<Astar<SearchNode, BucketQueue<SearchNode>>>&,
+    const Map&, const AgentSet&, int, int, int, int, bool (*)(const Node&, const Node&, const Map&, const AgentSet&),
+    bool, bool, int, int, int, const std::unordered_set<Node>&, const ConstraintsSet&, bool, const ConflictAvoidanceTable&,
+    std::chrono::steady_clock::time_point, int);
+template void ISearch<SearchNode, BucketQueue<SearchNode>>::generateSuccessors(
+    SearchEngine<Astar<SearchNode, BucketQueue<SearchNode>>>&,
+    const SearchNode&, const Map&, SuccessorBuffer<SearchNode>&, int, int, int, const std::unordered_set<Node>&,
+    const ConstraintsSet&, bool, const ConflictAvoidanceTable&);
+template SearchResult ISearch<SearchNode, BucketQueue<SearchNode>>::runSearch(
+    SearchEngine<FocalSearch<SearchNode, BucketQueue<SearchNode>, IndexedHeapQueue<SearchNode>>>&,
+    const Map&, const AgentSet&, int, int, int, int, bool (*)(const Node&, const Node&, const Map&, const AgentSet&),
+    bool, bool, int, int, int, const std::unordered_set<Node>&, const ConstraintsSet&, bool, const ConflictAvoidanceTable&,
+    std::chrono::steady_clock::time_point, int);
+template void ISearch<SearchNode, BucketQueue<SearchNode>>::generateSuccessors(
+    SearchEngine<FocalSearch<SearchNode, BucketQueue<SearchNode>, IndexedHeapQueue<SearchNode>>>&,
+    const SearchNode&, const Map&, SuccessorBuffer<SearchNode>&, int, int, int, const std::unordered_set<Node>&,
+    const ConstraintsSet&, bool, const ConflictAvoidanceTable&);
+template SearchResult ISearch<SearchNode, FocalQueue<SearchNode>>::runSearch(
+    SearchEngine<FocalSearch<SearchNode, FocalQueue<SearchNode>>>&,
+    const Map&, const AgentSet&, int, int, int, int, bool (*)(const Node&, const Node&, const Map&, const AgentSet&),
+    bool, bool, int, int, int, const std::unordered_set<Node>&, const ConstraintsSet&, bool, const ConflictAvoidanceTable&,
+    std::chrono::steady_clock::time_point, int);
+template void ISearch<SearchNode, FocalQueue<SearchNode>>::generateSuccessors(
+    SearchEngine<FocalSearch<SearchNode, FocalQueue<SearchNode>>>&,
+    const SearchNode&, const Map&, SuccessorBuffer<SearchNode>&, int, int, int, const std::unordered_set<Node>&,
+    const ConstraintsSet&, bool, const ConflictAvoidanceTable&);
+template SearchResult ISearch<SIPPNode, BucketQueue<SIPPNode>>::runSearch(SearchEngine<SIPP<>>&,
+    const Map&, const AgentSet&, int, int, int, int, bool (*)(const Node&, const Node&, const Map&, const AgentSet&),
+    bool, bool, int, int, int, const std::unordered_set<Node>&, const ConstraintsSet&, bool, const ConflictAvoidanceTable&,
+    std::chrono::steady_clock::time_point, int);
+template void ISearch<SIPPNode, BucketQueue<SIPPNode>>::generateSuccessors(SearchEngine<SIPP<>>&,
+    const SIPPNode&, const Map&, SuccessorBuffer<SIPPNode>&, int, int, int, const std::unordered_set<Node>&,
+    const ConstraintsSet&, bool, const ConflictAvoidanceTable&);
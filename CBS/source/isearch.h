@@ -16,11 +16,19 @@
 #include "constraints_set.h"
 #include "conflict_avoidance_table.h"
 #include "search_queue.h"
-
-template <typename NodeType = Node>
+#include "indexed_heap_queue.h"
+#include "bucket_queue.h"
+#include "focal_queue.h"
+#include "closed_table.h"
+#include "successor_buffer.h"
+#include "search_node.h"
+
+template <typename NodeType = Node, typename QueueType = SearchQueue<NodeType>>
 class ISearch
 {
     public:
+        typedef NodeType SearchNodeType;
+
         ISearch(bool WithTime = false);
         ISearch(ISearch& other) = default;
         ISearch& operator=(ISearch& other) = default;
@@ -38,11 +46,37 @@ class ISearch
                                  std::chrono::steady_clock::time_point globalBegin = std::chrono::steady_clock::time_point(),
                                  int globalTimeLimit = -1);
 
-        virtual std::list<NodeType> findSuccessors(const NodeType &curNode, const Map &map, int goal_i = 0, int goal_j = 0, int agentId = -1,
-                                               const std::unordered_set<Node> &occupiedNodes =
-                                                     std::unordered_set<Node>(),
-                                               const ConstraintsSet &constraints = ConstraintsSet(),
-                                               bool withCAT = false, const ConflictAvoidanceTable &CAT = ConflictAvoidanceTable());
+        virtual void findSuccessors(const NodeType &curNode, const Map &map, SuccessorBuffer<NodeType> &successors,
+                                    int goal_i = 0, int goal_j = 0, int agentId = -1,
+                                    const std::unordered_set<Node> &occupiedNodes =
+                                          std::unordered_set<Node>(),
+                                    const ConstraintsSet &constraints = ConstraintsSet(),
+                                    bool withCAT = false, const ConflictAvoidanceTable &CAT = ConflictAvoidanceTable());
+
+        // same as above, kept for callers that need a list
+        std::list<NodeType> findSuccessors(const NodeType &curNode, const Map &map, int goal_i = 0, int goal_j = 0, int agentId = -1,
+                                           const std::unordered_set<Node> &occupiedNodes =
+                                                 std::unordered_set<Node>(),
+                                           const ConstraintsSet &constraints = ConstraintsSet(),
+                                           bool withCAT = false, const ConflictAvoidanceTable &CAT = ConflictAvoidanceTable());
+
+        // Bodies of startSearch and findSuccessors. All hooks are called through self,
+        // so they are bound at compile time when Self is a final class (see SearchEngine).
+        template<typename Self>
+        SearchResult runSearch(Self &self, const Map &map, const AgentSet &agentSet,
+                               int start_i, int start_j, int goal_i, int goal_j,
+                               bool (*isGoal)(const Node&, const Node&, const Map&, const AgentSet&),
+                               bool freshStart, bool returnPath, int startTime, int goalTime, int maxTime,
+                               const std::unordered_set<Node> &occupiedNodes,
+                               const ConstraintsSet &constraints,
+                               bool withCAT, const ConflictAvoidanceTable &CAT,
+                               std::chrono::steady_clock::time_point globalBegin, int globalTimeLimit);
+        template<typename Self>
+        void generateSuccessors(Self &self, const NodeType &curNode, const Map &map, SuccessorBuffer<NodeType> &successors,
+                                int goal_i, int goal_j, int agentId,
+                                const std::unordered_set<Node> &occupiedNodes,
+                                const ConstraintsSet &constraints,
+                                bool withCAT, const ConflictAvoidanceTable &CAT);
 
         //static int convolution(int i, int j, const Map &map, int time = 0, bool withTime = false);
 
@@ -78,11 +112,13 @@ class ISearch
         //and only then begin enhancement
 
         virtual void makePrimaryPath(Node &curNode, int endTime);//Makes path using back pointers
+        template<typename PoolNode>
+        void makePrimaryPathFromPool(const PoolNode &curNode, int endTime);//Same for nodes with parent indices into CLOSE
         virtual void makeSecondaryPath(const Map &map);//Makes another type of path(sections or points)
         virtual void setEndTime(NodeType& node, int start_i, int start_j, int startTime, int agentId, const ConstraintsSet &constraints);
         virtual void setHC(NodeType &neigh, const NodeType &cur,
                            const ConflictAvoidanceTable &CAT, bool isGoal) {}
-        virtual void createSuccessorsFromNode(const NodeType &cur, NodeType &neigh, std::list<NodeType> &successors,
+        virtual void createSuccessorsFromNode(const NodeType &cur, NodeType &neigh, SuccessorBuffer<NodeType> &successors,
                                               int agentId, const ConstraintsSet &constraints,
                                               const ConflictAvoidanceTable &CAT, bool isGoal);
         virtual bool checkGoal(const NodeType &cur, int goalTime, int agentId, const ConstraintsSet &constraints);
@@ -107,8 +143,8 @@ class ISearch
         std::list<Node>                     lppath, hppath;
         double                              hweight;//weight of h-value
         bool                                breakingties;//flag that sets the priority of nodes in addOpen function when their F-values is equal
-        SearchQueue<NodeType>               open;
-        std::unordered_map<int, NodeType>   close;
+        QueueType                           open;
+        ClosedTable<NodeType>               close;
         bool                                withTime;
         //need to define open, close;
 
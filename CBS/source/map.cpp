@@ -151,6 +151,14 @@ bool Map::getMap(const char *FileName)
         return false;
     }
 
+    traversable = Bitboard(height, width);
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            if (Grid[i][j] == CN_GC_NOOBS) {
+                traversable.set(i, j);
+            }
+        }
+    }
     return true;
 }
 
@@ -179,6 +187,10 @@ int Map::getEmptyCellCount() const {
     return emptyCellCount;
 }
 
+const Bitboard& Map::getTraversable() const {
+    return traversable;
+}
+
 double Map::getCellSize() const
 {
       return cellSize;
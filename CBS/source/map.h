@@ -11,6 +11,7 @@
 #include "gl_const.h"
 #include "tinyxml2.h"
 #include "agent_set.h"
+#include "bitboard.h"
 
 //That's the class that stores BOTH grid map data AND start-goal locations.
 //getValue reads the input XML and fills the Map object.
@@ -28,6 +29,7 @@ class Map
         int     emptyCellCount;
         double  cellSize;
         int**   Grid;
+        Bitboard traversable;  // bits of the cells without obstacles
 
     public:
         Map();
@@ -44,6 +46,8 @@ class Map
         int getEmptyCellCount() const;
         int getCellDegree(int i, int j) const;
         double getCellSize() const;
+        // the set of cells without obstacles
+        const Bitboard& getTraversable() const;
 };
 
 #endif
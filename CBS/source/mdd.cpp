@@ -1,10 +1,395 @@
 #include "mdd.h"
+#include <cstdlib>
+
+const int MDD::moveOffsets[5][2] = {{-1, 0}, {0, -1}, {0, 0}, {0, 1}, {1, 0}};
 
 MDD::MDD() {};
 
+MDD::MDD(const Map& map, const AgentSet& agentSet, int agentId, int cost, const ConstraintsSet& constraints) {
+    Agent agent = agentSet.getAgent(agentId);
+    int start_i = agent.getStart_i(), start_j = agent.getStart_j();
+    int goal_i = agent.getGoal_i(), goal_j = agent.getGoal_j();
+    std::vector<Layer> graph(cost + 1);
+    // a path of the cost goes at most slack cells away from the rectangle of the start and the goal
+    int slack = (cost - std::abs(start_i - goal_i) - std::abs(start_j - goal_j)) / 2;
+    if (slack < 0 || cost < constraints.getMinGoalTime(goal_i, goal_j, agentId) ||
+            cost > constraints.getMaxGoalTime(goal_i, goal_j, agentId)) {
+        setGraph(std::move(graph));
+        return;
+    }
+    int top = std::max(0, std::min(start_i, goal_i) - slack);
+    int left = std::max(0, std::min(start_j, goal_j) - slack);
+    int height = std::min(map.getMapHeight() - 1, std::max(start_i, goal_i) + slack) - top + 1;
+    int width = std::min(map.getMapWidth() - 1, std::max(start_j, goal_j) + slack) - left + 1;
+    Bitboard traversable(map.getTraversable(), top, left, height, width);
+
+    // cells of the rectangle that are blocked at every time and moves into them that are forbidden
+    std::vector<std::vector<std::pair<int, int>>> blockedCells(cost + 1), blockedMoves(cost + 1);
+    for (auto &cell : constraints.cells) {
+        int i = cell.i - top, j = cell.j - left;
+        if (i < 0 || i >= height || j < 0 || j >= width) {
+            continue;
+        }
+        for (auto &entry : cell.nodes) {
+            if (entry.agentId == agentId && entry.time > 0 && entry.time <= cost) {
+                blockedCells[entry.time].emplace_back(i, j);
+            }
+        }
+        for (auto &entry : cell.goals) {
+            if (entry.agentId == agentId) {
+                for (int time = std::max(1, entry.time); time <= cost; ++time) {
+                    blockedCells[time].emplace_back(i, j);
+                }
+            }
+        }
+        for (auto &entry : cell.edges) {
+            if (entry.agentId == agentId && entry.time > 0 && entry.time <= cost) {
+                blockedMoves[entry.time].emplace_back(i, j);
+            }
+        }
+    }
+    auto canMove = [&](int i, int j, int to_i, int to_j, int time) {
+        return blockedMoves[time].empty() ||
+               !constraints.hasEdgeConstraint(to_i + top, to_j + left, time, agentId, i + top, j + left);
+    };
+    // a cell of layer time has a move from a cell of layer time - 1 (or to a cell of layer time + 1 if backward)
+    auto hasMove = [&](const Bitboard &layer, int i, int j, int time, bool backward) {
+        for (int move = 0; move < 5; ++move) {
+            int ni = i + moveOffsets[move][0], nj = j + moveOffsets[move][1];
+            if (ni >= 0 && ni < height && nj >= 0 && nj < width && layer.get(ni, nj) &&
+                    (backward ? canMove(i, j, ni, nj, time + 1) : canMove(ni, nj, i, j, time))) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // the cells of a layer are within time rows from the start and within cost - time rows from the goal
+    std::vector<int> firstRow(cost + 1), lastRow(cost + 1);
+    for (int time = 0; time <= cost; ++time) {
+        firstRow[time] = std::max(0, std::max(start_i - top - time, goal_i - top - (cost - time)));
+        lastRow[time] = std::min(height - 1, std::min(start_i - top + time, goal_i - top + (cost - time)));
+    }
+
+    std::vector<Bitboard> layers(cost + 1, Bitboard(height, width));
+    layers[0].set(start_i - top, start_j - left);
+    for (int time = 1; time <= cost; ++time) {
+        layers[time - 1].expand(layers[time], firstRow[time], lastRow[time]);
+        layers[time].intersect(traversable, firstRow[time], lastRow[time]);
+        for (auto &cell : blockedCells[time]) {
+            layers[time].reset(cell.first, cell.second);
+        }
+        for (auto &cell : blockedMoves[time]) {
+            if (layers[time].get(cell.first, cell.second) &&
+                    !hasMove(layers[time - 1], cell.first, cell.second, time, false)) {
+                layers[time].reset(cell.first, cell.second);
+            }
+        }
+    }
+
+    bool goalReached = layers[cost].get(goal_i - top, goal_j - left);
+    layers[cost] = Bitboard(height, width);
+    if (goalReached) {
+        layers[cost].set(goal_i - top, goal_j - left);
+    }
+    Bitboard predecessors(height, width);
+    for (int time = cost - 1; time >= 0; --time) {
+        layers[time + 1].expand(predecessors, firstRow[time], lastRow[time]);
+        layers[time].intersect(predecessors, firstRow[time], lastRow[time]);
+        for (auto &cell : blockedMoves[time + 1]) {
+            for (int move = 0; move < 5; ++move) {
+                int i = cell.first - moveOffsets[move][0], j = cell.second - moveOffsets[move][1];
+                if (i >= 0 && i < height && j >= 0 && j < width && layers[time].get(i, j) &&
+                        !hasMove(layers[time + 1], i, j, time, true)) {
+                    layers[time].reset(i, j);
+                }
+            }
+        }
+    }
+
+    for (int time = 0; time <= cost; ++time) {
+        Layer &layer = graph[time];
+        int count = layers[time].count(firstRow[time], lastRow[time]);
+        layer.cells.reserve(count);
+        layer.moves.reserve(count);
+        layers[time].forEach([&](int i, int j) {
+            unsigned char moves = 0;
+            for (int move = 0; time < cost && move < 5; ++move) {
+                int ni = i + moveOffsets[move][0], nj = j + moveOffsets[move][1];
+                if (ni >= 0 && ni < height && nj >= 0 && nj < width && layers[time + 1].get(ni, nj) &&
+                        canMove(i, j, ni, nj, time + 1)) {
+                    moves |= 1 << move;
+                }
+            }
+            layer.cells.push_back(Path::packCell(i + top, j + left));
+            layer.moves.push_back(moves);
+        }, firstRow[time], lastRow[time]);
+    }
+    setGraph(std::move(graph));
+}
+
+MDD::MDD(const MDD &mdd, const Constraint &constraint) {
+    *this = mdd;
+    if (empty()) {
+        return;
+    }
+
+    if (constraint.length != 0) {
+        // the path of the MDD ends in the goal at its cost, so it satisfies the constraint or none of its paths does
+        if (constraint.length == 1 ? getCost() <= constraint.time : getCost() > constraint.time) {
+            setGraph(std::vector<Layer>(layerSizes.size()));
+        }
+    } else if (constraint.goalNode) {
+        std::vector<Layer> graph(*layers);
+        int cell = Path::packCell(constraint.i, constraint.j);
+        bool removed = false;
+        for (int time = std::max(1, constraint.time); time <= getCost(); ++time) {
+            int k = findCell(graph[time], cell);
+            if (k != -1) {
+                graph[time].cells.erase(graph[time].cells.begin() + k);
+                graph[time].moves.erase(graph[time].moves.begin() + k);
+                removeDeadNodes(graph, time - 1, time + 1);
+                removed = true;
+            }
+        }
+        if (removed) {
+            setGraph(std::move(graph));
+        }
+    } else if (constraint.prev_i == -1) {
+        // the graph is copied only when one of the vertex constraints removes a node
+        std::vector<Layer> graph;
+        constraint.forEachVertex([&](int i, int j, int time) {
+            if (time <= 0 || time > getCost()) {
+                return;
+            }
+            const std::vector<Layer> &cur = graph.empty() ? *layers : graph;
+            int k = findCell(cur[time], Path::packCell(i, j));
+            if (k == -1) {
+                return;
+            }
+            if (graph.empty()) {
+                graph = *layers;
+            }
+            graph[time].cells.erase(graph[time].cells.begin() + k);
+            graph[time].moves.erase(graph[time].moves.begin() + k);
+            removeDeadNodes(graph, time - 1, time + 1);
+        });
+        if (!graph.empty()) {
+            setGraph(std::move(graph));
+        }
+    } else {
+        int time = constraint.time;
+        if (time <= 0 || time > getCost()) {
+            return;
+        }
+        int k = findCell((*layers)[time - 1], Path::packCell(constraint.prev_i, constraint.prev_j));
+        int move = getMove(constraint.prev_i, constraint.prev_j, constraint.i, constraint.j);
+        if (k == -1 || move == -1 || !((*layers)[time - 1].moves[k] >> move & 1)) {
+            return;
+        }
+        std::vector<Layer> graph(*layers);
+        graph[time - 1].moves[k] &= ~(1 << move);
+        removeDeadNodes(graph, time - 1, time);
+        setGraph(std::move(graph));
+    }
+}
+
 int MDD::getLayerSize(int cost) const {
-    if (cost > layerSizes.size()) {
+    if (cost >= layerSizes.size()) {
          return 1;
     }
     return layerSizes[cost];
 }
+
+int MDD::getCost() const {
+    return layerSizes.size() - 1;
+}
+
+bool MDD::empty() const {
+    return layerSizes.empty();
+}
+
+bool MDD::hasPaths() const {
+    return !empty() && std::find(layerSizes.begin(), layerSizes.end(), 0) == layerSizes.end();
+}
+
+bool MDD::hasConflictFreePaths(const MDD &mdd1, const MDD &mdd2, int maxStates) {
+    if (!mdd1.hasPaths() || !mdd2.hasPaths()) {
+        return false;
+    }
+
+    // depth first search for a path in the product of the MDDs, a state is (time, node of mdd1, node of mdd2)
+    int cost = std::max(mdd1.getCost(), mdd2.getCost());
+    auto getKey = [](int time, int k1, int k2) {
+        return (uint64_t(time) << 42) | (uint64_t(k1) << 21) | uint64_t(k2);
+    };
+    std::vector<std::tuple<int, int, int>> stack = {std::make_tuple(0, 0, 0)};
+    std::unordered_set<uint64_t> visited = {getKey(0, 0, 0)};
+    std::vector<std::pair<int, int>> successors1, successors2;
+    while (!stack.empty()) {
+        int time, k1, k2;
+        std::tie(time, k1, k2) = stack.back();
+        stack.pop_back();
+        if (time == cost || (maxStates != -1 && int(visited.size()) > maxStates)) {
+            return true;
+        }
+        int cell1 = (*mdd1.layers)[std::min(time, mdd1.getCost())].cells[k1];
+        int cell2 = (*mdd2.layers)[std::min(time, mdd2.getCost())].cells[k2];
+        mdd1.getSuccessors(time, k1, successors1);
+        mdd2.getSuccessors(time, k2, successors2);
+        for (auto &successor1 : successors1) {
+            for (auto &successor2 : successors2) {
+                if (successor1.second == successor2.second ||
+                        (successor1.second == cell2 && successor2.second == cell1)) {
+                    continue;
+                }
+                uint64_t key = getKey(time + 1, successor1.first, successor2.first);
+                if (visited.insert(key).second) {
+                    stack.emplace_back(time + 1, successor1.first, successor2.first);
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void MDD::getSuccessors(int time, int k, std::vector<std::pair<int, int>> &res) const {
+    res.clear();
+    const std::vector<Layer> &graph = *layers;
+    if (time >= getCost()) {
+        res.emplace_back(k, graph.back().cells[k]);
+        return;
+    }
+    int i = Path::unpackI(graph[time].cells[k]), j = Path::unpackJ(graph[time].cells[k]);
+    for (int move = 0; move < 5; ++move) {
+        if (graph[time].moves[k] >> move & 1) {
+            int cell = Path::packCell(i + moveOffsets[move][0], j + moveOffsets[move][1]);
+            int index = findCell(graph[time + 1], cell);
+            if (index != -1) {
+                res.emplace_back(index, cell);
+            }
+        }
+    }
+}
+
+int MDD::getMove(int i, int j, int to_i, int to_j) {
+    for (int move = 0; move < 5; ++move) {
+        if (i + moveOffsets[move][0] == to_i && j + moveOffsets[move][1] == to_j) {
+            return move;
+        }
+    }
+    return -1;
+}
+
+int MDD::findCell(const Layer &layer, int cell) {
+    auto it = std::lower_bound(layer.cells.begin(), layer.cells.end(), cell);
+    return it != layer.cells.end() && *it == cell ? it - layer.cells.begin() : -1;
+}
+
+bool MDD::removeNodesWithoutSuccessors(std::vector<Layer> &graph, int time) {
+    Layer &layer = graph[time];
+    const Layer &next = graph[time + 1];
+    int count = 0;
+    for (int k = 0; k < int(layer.cells.size()); ++k) {
+        int i = Path::unpackI(layer.cells[k]), j = Path::unpackJ(layer.cells[k]);
+        unsigned char moves = layer.moves[k];
+        for (int move = 0; move < 5; ++move) {
+            if ((moves >> move & 1) &&
+                    findCell(next, Path::packCell(i + moveOffsets[move][0], j + moveOffsets[move][1])) == -1) {
+                moves &= ~(1 << move);
+            }
+        }
+        if (moves != 0) {
+            layer.cells[count] = layer.cells[k];
+            layer.moves[count++] = moves;
+        }
+    }
+    if (count == int(layer.cells.size())) {
+        return false;
+    }
+    layer.cells.resize(count);
+    layer.moves.resize(count);
+    return true;
+}
+
+bool MDD::removeNodesWithoutPredecessors(std::vector<Layer> &graph, int time) {
+    const Layer &prev = graph[time - 1];
+    Layer &layer = graph[time];
+    std::vector<bool> reached(layer.cells.size(), false);
+    for (int k = 0; k < int(prev.cells.size()); ++k) {
+        int i = Path::unpackI(prev.cells[k]), j = Path::unpackJ(prev.cells[k]);
+        for (int move = 0; move < 5; ++move) {
+            if (prev.moves[k] >> move & 1) {
+                int index = findCell(layer, Path::packCell(i + moveOffsets[move][0], j + moveOffsets[move][1]));
+                if (index != -1) {
+                    reached[index] = true;
+                }
+            }
+        }
+    }
+    int count = 0;
+    for (int k = 0; k < int(layer.cells.size()); ++k) {
+        if (reached[k]) {
+            layer.cells[count] = layer.cells[k];
+            layer.moves[count++] = layer.moves[k];
+        }
+    }
+    if (count == int(layer.cells.size())) {
+        return false;
+    }
+    layer.cells.resize(count);
+    layer.moves.resize(count);
+    return true;
+}
+
+void MDD::removeDeadNodes(std::vector<Layer> &graph, int last, int first) {
+    // a removed node takes away the moves of its predecessors or into its successors,
+    // so the passes go on while nodes are removed
+    for (int time = last; time >= 0 && removeNodesWithoutSuccessors(graph, time); --time) {}
+    for (int time = first; time < int(graph.size()) && removeNodesWithoutPredecessors(graph, time); ++time) {}
+}
+
+void MDD::setGraph(std::vector<Layer> &&graph) {
+    layerSizes.resize(graph.size());
+    for (int time = 0; time < int(graph.size()); ++time) {
+        layerSizes[time] = graph[time].cells.size();
+    }
+    layers = std::make_shared<const std::vector<Layer>>(std::move(graph));
+}
+
+size_t MDDCache::KeyHash::operator()(const Key &key) const {
+    size_t res = key.agentId * 73856093u ^ key.cost * 19349663u;
+    return res ^ (getHash(key.constraints) + 0x9e3779b9 + (res << 6) + (res >> 2));
+}
+
+MDD& MDDCache::get(int agentId, int cost, const ConstraintsList &constraints) {
+    return mdds[Key{agentId, cost, getConstraints(constraints)}];
+}
+
+std::vector<Constraint> MDDCache::getConstraints(const ConstraintsList &constraints) {
+    std::vector<Constraint> res;
+    for (const ConstraintsListNode *cur = constraints.get(); cur != nullptr; cur = cur->next.get()) {
+        if (!cur->constraint.positive) {
+            res.push_back(cur->constraint);
+        }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+size_t MDDCache::getHash(const std::vector<Constraint> &constraints) {
+    size_t res = 0;
+    for (const Constraint &constraint : constraints) {
+        size_t h = unsigned(constraint.i) * 73856093u ^ unsigned(constraint.j) * 19349663u ^
+                   unsigned(constraint.time) * 83492791u ^ unsigned(constraint.prev_i) * 2654435761u ^
+                   unsigned(constraint.prev_j) * 40503u ^ unsigned(constraint.goalNode) ^
+                   unsigned(constraint.dur) * 1099087573u ^ unsigned(constraint.end_i) * 2246822519u ^
+                   unsigned(constraint.end_j) * 3266489917u ^ unsigned(constraint.length + 1) * 668265263u;
+        res ^= h + 0x9e3779b9 + (res << 6) + (res >> 2);
+    }
+    return res;
+}
+
+void MDDCache::clear() {
+    mdds.clear();
+}
@@ -2,75 +2,101 @@
 #define MDD_H
 
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
+#include <tuple>
+#include <cstdint>
 #include "constraints_set.h"
 #include "map.h"
 #include "agent_set.h"
 #include "isearch.h"
 #include "astar.h"
+#include "path.h"
+#include "bitboard.h"
 
+// Multi-value decision diagram of an agent: the cells it can be in at every time on a path of the given cost
+// that satisfies its constraints, and the moves between them. A layer holds the sorted packed cells of one time
+// and, for every cell, a bit mask of the moves that lead to the next layer. The graph is immutable and shared
+// by the copies of an MDD, an MDD with one more node or edge constraint is made by pruning a copy of it.
+// A new MDD is built on bitboards of the rectangle that can hold its cells: a layer is the set of cells reachable
+// from the start, found by expanding the previous layer, and then intersected with the cells the goal is reachable from.
+// Only the rows within reach of both the start and the goal at the time of a layer are swept.
 class MDD
 {
 public:
     MDD();
-    template<typename SearchType>
-    MDD(const Map& map, const AgentSet& agentSet, SearchType* search, int agentId, int cost,
+    MDD(const Map& map, const AgentSet& agentSet, int agentId, int cost,
         const ConstraintsSet& constraints = ConstraintsSet());
+    // mdd with the node, goal node, edge, range, barrier or length constraint added to the constraints it was built with
+    MDD(const MDD &mdd, const Constraint &constraint);
 
     int getLayerSize(int cost) const;
+    int getCost() const;
+    bool empty() const;
+    // false if the constraints left no path of the cost
+    bool hasPaths() const;
+    // true if the agents of mdd1 and mdd2 can follow paths from their MDDs without conflicts,
+    // an agent stays in its goal after the end of its MDD. The search gives up and returns true
+    // after maxStates pairs of nodes, so false is always exact
+    static bool hasConflictFreePaths(const MDD &mdd1, const MDD &mdd2, int maxStates = -1);
 
 //private:
-    std::vector<int> layerSizes;
-};
+    struct Layer
+    {
+        std::vector<int>            cells;
+        std::vector<unsigned char>  moves;  // bit k is set if the move moveOffsets[k] leads to a cell of the next layer
+    };
 
-template <typename SearchType>
-MDD::MDD(const Map& map, const AgentSet& agentSet, SearchType* search, int agentId, int cost, const ConstraintsSet& constraints) {
-    Astar<> astar;
-    Agent agent = agentSet.getAgent(agentId);
-    Node start = agent.getStartPosition(), goal = agent.getGoalPosition();
-    std::vector<std::unordered_set<Node>> layers;
-    layers.push_back({start});
+    static const int moveOffsets[5][2];
 
-    int t = 0;
-    int q = 0;
+    static int getMove(int i, int j, int to_i, int to_j);
+    // pairs (index, cell) of the successors of node k of the layer at time, the goal is its own successor after the end
+    void getSuccessors(int time, int k, std::vector<std::pair<int, int>> &res) const;
+    static int findCell(const Layer &layer, int cell);
+    // remove the nodes of the layer that have no moves to the next layer or from the previous one,
+    // return false if there are none
+    static bool removeNodesWithoutSuccessors(std::vector<Layer> &graph, int time);
+    static bool removeNodesWithoutPredecessors(std::vector<Layer> &graph, int time);
+    // removes the dead nodes after the moves from layer last or into layer first were taken away
+    static void removeDeadNodes(std::vector<Layer> &graph, int last, int first);
+    void setGraph(std::vector<Layer> &&graph);
 
-    for (int i = 0; i < cost - 1; ++i) {
-        layers.push_back({});
-        for (auto node : layers[i]) {
+    std::vector<int>                            layerSizes;
+    std::shared_ptr<const std::vector<Layer>>   layers;
+};
 
-            std::chrono::steady_clock::time_point a = std::chrono::steady_clock::now();
+// MDDs by agent, cost and set of negative constraints of the agent. CT nodes of different branches that constrain
+// an agent in the same way get the same MDD, which is built once.
+class MDDCache
+{
+public:
+    // the MDD of agentId with cost under the constraints of the list, an empty MDD to be filled if it is not cached yet
+    MDD& get(int agentId, int cost, const ConstraintsList &constraints);
+    void clear();
 
-            std::list<Node> successors = astar.findSuccessors(node, map, goal.i, goal.j, agentId, {}, constraints);
+    // negative constraints of the list sorted, so equal sets of constraints give equal vectors
+    static std::vector<Constraint> getConstraints(const ConstraintsList &constraints);
+    static size_t getHash(const std::vector<Constraint> &constraints);
 
-            std::chrono::steady_clock::time_point b = std::chrono::steady_clock::now();
-            q += std::chrono::duration_cast<std::chrono::microseconds>(b - a).count();
-            ++t;
+//private:
+    struct Key
+    {
+        int                     agentId, cost;
+        std::vector<Constraint> constraints;  // sorted
 
-            for (auto neigh : successors) {
-                if (search->computeHFromCellToCell(neigh.i, neigh.j, goal.i, goal.j) <= cost - i - 1) {
-                    layers.back().insert(neigh);
-                }
-            }
+        bool operator== (const Key &other) const {
+            return agentId == other.agentId && cost == other.cost && constraints == other.constraints;
         }
-    }
+    };
 
-    layerSizes.resize(cost + 1, 0);
-    layerSizes[cost] = 1;
-    std::unordered_set<Node> lastLayer = {goal};
-    for (int i = cost - 1; i >= 0; --i) {
-        std::unordered_set<Node> newLastLayer;
-        for (auto node : layers[i]) {
-            std::list<Node> successors = astar.findSuccessors(node, map, goal.i, goal.j, agentId, {}, constraints);
-            for (auto neigh : successors) {
-                if (lastLayer.find(neigh) != lastLayer.end()) {
-                    newLastLayer.insert(node);
-                    break;
-                }
-            }
-        }
-        layerSizes[i] = newLastLayer.size();
-        lastLayer = newLastLayer;
-    }
-}
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    std::unordered_map<Key, MDD, KeyHash> mdds;
+};
 
 #endif // MDD_H
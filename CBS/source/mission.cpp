@@ -49,12 +49,19 @@ bool Mission::createLog()
 
 void Mission::createAlgorithm()
 {
+    // moves are unit-cost on 4-connected grid and both Manhattan and perfect heuristics are integer,
+    // so OPEN of A* is always kept in F-buckets and all costs fit into the integer fields of SearchNode.
+    // Focal search keeps OPEN and FOCAL in one FocalQueue. SIPP uses F-buckets too, keyed by cell and safe interval
     if (config.searchType == CN_ST_CBS) {
         if (config.lowLevel == CN_SP_ST_ASTAR) {
-            multiagentSearch = new ConflictBasedSearch<Astar<>>(new Astar<>(true));
+            multiagentSearch = new ConflictBasedSearch<SearchEngine<Astar<SearchNode, BucketQueue<SearchNode>>>>(
+                new SearchEngine<Astar<SearchNode, BucketQueue<SearchNode>>>(true));
         } else if (config.lowLevel == CN_SP_ST_FS) {
-            multiagentSearch = new ConflictBasedSearch<FocalSearch<>>(new FocalSearch<>(true, config.focalW));
-        } 
+            multiagentSearch = new ConflictBasedSearch<SearchEngine<FocalSearch<SearchNode, FocalQueue<SearchNode>>>>(
+                new SearchEngine<FocalSearch<SearchNode, FocalQueue<SearchNode>>>(true, config.focalW));
+        } else if (config.lowLevel == CN_SP_ST_SIPP) {
+            multiagentSearch = new ConflictBasedSearch<SearchEngine<SIPP<>>>(new SearchEngine<SIPP<>>());
+        }
     }
 }
 
@@ -185,7 +192,7 @@ bool Mission::checkCorrectness() {
     for (int j = 0; j < agentCount; ++j) {
         solutionSize = std::max(solutionSize, agentsPaths[j].size());
     }
-    std::vector<std::vector<Node>::iterator> starts, ends;
+    std::vector<Path> paths;
     for (int j = 0; j < agentCount; ++j) {
         if (agentsPaths[j][0] != agentSet.getAgent(j).getStartPosition()) {
             std::cout << "Incorrect result: agent path starts in wrong position!" << std::endl;
@@ -195,8 +202,7 @@ bool Mission::checkCorrectness() {
             std::cout << "Incorrect result: agent path ends in wrong position!" << std::endl;
             return false;
         }
-        starts.push_back(agentsPaths[j].begin());
-        ends.push_back(agentsPaths[j].end());
+        paths.emplace_back(agentsPaths[j].begin(), agentsPaths[j].end());
     }
 
     for (int i = 0; i < solutionSize; ++i) {
@@ -216,7 +222,11 @@ bool Mission::checkCorrectness() {
             }
         }
     }
-    ConflictSet conflictSet = ConflictBasedSearch<>::findConflict<std::vector<Node>::iterator>(starts, ends);
+    std::vector<const Path*> pathPtrs;
+    for (const Path &path : paths) {
+        pathPtrs.push_back(&path);
+    }
+    ConflictSet conflictSet = ConflictBasedSearch<>::findConflict(pathPtrs);
     if (!conflictSet.empty()) {
         Conflict conflict = conflictSet.getBestConflict();
         if (conflict.edgeConflict) {
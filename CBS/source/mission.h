@@ -11,6 +11,8 @@
 #include "searchresult.h"
 #include "astar.h"
 #include "focalsearch.h"
+#include "sipp.h"
+#include "search_engine.h"
 #include "xmllogger.h"
 #include "multiagent_search_interface.h"
 #include "testing_results.h"
@@ -6,6 +6,7 @@
 #include "map.h"
 #include "multiagent_search_result.h"
 #include "isearch.h"
+#include "perfect_heuristic.h"
 #include <vector>
 #include <unordered_map>
 
@@ -16,44 +17,18 @@ public:
     virtual MultiagentSearchResult startSearch(const Map &map, const Config &config, AgentSet &AgentSet,
         std::chrono::steady_clock::time_point globalBegin = std::chrono::steady_clock::time_point(),
         int globalTimeLimit = -1) = 0;
+    // perfect heuristic is kept, it depends only on the map and gets tables for new goals on demand
     virtual void clear() {
         agentsPaths.clear();
-        perfectHeuristic.clear();
     }
 
-    void getPerfectHeuristic(const Map &map, const AgentSet &agentSet) {
-        if (!perfectHeuristic.empty()) {
-            return;
-        }
-
-        std::unordered_set<int> visited;
-        ISearch<> search(false);
-        for (int i = 0; i < agentSet.getAgentCount(); ++i) {
-            //std::cout << i << std::endl;
-
-            visited.clear();
-            Node goal = Node(agentSet.getAgent(i).getGoal_i(), agentSet.getAgent(i).getGoal_j());
-            std::queue<Node> queue;
-            queue.push(goal);
-            while (!queue.empty()) {
-                Node cur = queue.front();
-                queue.pop();
-                if (visited.find(cur.convolution(map.getMapWidth(), map.getMapHeight())) != visited.end()) {
-                    continue;
-                }
-                perfectHeuristic[std::make_pair(cur, goal)] = cur.g;
-                visited.insert(cur.convolution(map.getMapWidth(), map.getMapHeight()));
-                std::list<Node> successors = search.findSuccessors(cur, map);
-                for (const auto& neigh : successors) {
-                    queue.push(neigh);
-                }
-            }
-        }
+    void getPerfectHeuristic(const Map &map, const AgentSet &agentSet, const std::string &cacheDir = "") {
+        perfectHeuristic.update(map, agentSet, cacheDir);
     }
 
 //protected:
     std::vector<std::vector<Node>>  agentsPaths;
-    std::unordered_map<std::pair<Node, Node>, int> perfectHeuristic;
+    PerfectHeuristic perfectHeuristic;
 };
 
 #endif // MULTIAGENT_SEARCH_INTEFACE_H
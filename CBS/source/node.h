@@ -45,6 +45,11 @@ struct Node
     }
 };
 
+// Time layer of the node in CLOSE of a search with time
+inline int getTimeLayer(const Node &node) {
+    return node.g;
+}
+
 static size_t elegantPairing(const int &k1, const int &k2) 
 {
     return k1 < k2 ? k2 * k2 + k1 : k1 * k1 + k1 + k2;
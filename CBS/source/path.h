@@ -0,0 +1,43 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include <vector>
+#include <algorithm>
+#include "node.h"
+
+// Path of an agent as its cell at every timestep, the cell at time t is cells[t] and the agent stays
+// in the last cell after the end. A cell is packed into 32 bits as i << 16 | j, so the path is
+// a contiguous array of 4 bytes per timestep instead of a list of Nodes.
+class Path
+{
+public:
+    Path() = default;
+    template<typename Iter>
+    Path(Iter begin, Iter end) {
+        for (auto it = begin; it != end; ++it) {
+            push_back(it->i, it->j);
+        }
+    }
+
+    static int packCell(int i, int j) { return (i << 16) | j; }
+    static int unpackI(int cell) { return cell >> 16; }
+    static int unpackJ(int cell) { return cell & 0xFFFF; }
+
+    void push_back(int i, int j) { cells.push_back(packCell(i, j)); }
+    void push_back(int cell) { cells.push_back(cell); }
+    void clear() { cells.clear(); }
+    int size() const { return cells.size(); }
+    bool empty() const { return cells.empty(); }
+    int getCost() const { return cells.size() - 1; }
+
+    int getCell(int time) const { return cells[std::min<int>(time, cells.size() - 1)]; }
+    int getI(int time) const { return unpackI(getCell(time)); }
+    int getJ(int time) const { return unpackJ(getCell(time)); }
+    Node getNode(int time) const { return Node(getI(time), getJ(time), nullptr, time); }
+    int back() const { return cells.back(); }
+
+//private:
+    std::vector<int> cells;
+};
+
+#endif // PATH_H
@@ -0,0 +1,66 @@
+#include "path_table.h"
+
+PathTable::PathTable(int height, int width) : cells(height * width), width(width) {}
+
+void PathTable::addAgentPath(const Path &path, int agentId) {
+    for (int time = 0; time + 1 < path.size(); ++time) {
+        auto &nodes = cells[getIndex(path.getCell(time))].nodes;
+        auto entry = std::make_pair(time, agentId);
+        nodes.insert(std::lower_bound(nodes.begin(), nodes.end(), entry), entry);
+    }
+    cells[getIndex(path.back())].goals.emplace_back(path.getCost(), agentId);
+}
+
+void PathTable::removeAgentPath(const Path &path, int agentId) {
+    for (int time = 0; time + 1 < path.size(); ++time) {
+        auto &nodes = cells[getIndex(path.getCell(time))].nodes;
+        nodes.erase(std::lower_bound(nodes.begin(), nodes.end(), std::make_pair(time, agentId)));
+    }
+    auto &goals = cells[getIndex(path.back())].goals;
+    goals.erase(std::find(goals.begin(), goals.end(), std::make_pair(path.getCost(), agentId)));
+}
+
+void PathTable::getAgents(int cell, int time, int agentId, std::vector<int> &res) const {
+    res.clear();
+    const CellAgents &cellAgents = cells[getIndex(cell)];
+    auto it = std::lower_bound(cellAgents.nodes.begin(), cellAgents.nodes.end(), std::make_pair(time, -1));
+    for (; it != cellAgents.nodes.end() && it->first == time; ++it) {
+        if (it->second != agentId) {
+            res.push_back(it->second);
+        }
+    }
+    bool sorted = true;
+    for (auto &goal : cellAgents.goals) {
+        if (goal.first <= time && goal.second != agentId) {
+            sorted = sorted && (res.empty() || res.back() < goal.second);
+            res.push_back(goal.second);
+        }
+    }
+    if (!sorted) {
+        std::sort(res.begin(), res.end());
+    }
+}
+
+void PathTable::getAgents(int cell, int startTime, int endTime, int agentId,
+                          std::vector<std::pair<int, int>> &res) const {
+    res.clear();
+    const CellAgents &cellAgents = cells[getIndex(cell)];
+    auto it = std::lower_bound(cellAgents.nodes.begin(), cellAgents.nodes.end(), std::make_pair(startTime, -1));
+    for (; it != cellAgents.nodes.end() && it->first < endTime; ++it) {
+        if (it->second != agentId) {
+            res.push_back(*it);
+        }
+    }
+    bool withGoals = false;
+    for (auto &goal : cellAgents.goals) {
+        if (goal.second != agentId) {
+            for (int time = std::max(startTime, goal.first); time < endTime; ++time) {
+                res.emplace_back(time, goal.second);
+                withGoals = true;
+            }
+        }
+    }
+    if (withGoals) {
+        std::sort(res.begin(), res.end());
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef PATH_TABLE_H
+#define PATH_TABLE_H
+
+#include <vector>
+#include <algorithm>
+#include "path.h"
+
+// Paths of the agents indexed by cell of the map. Every cell has the (time, agent) pairs of the agents that are in it
+// before the ends of their paths, sorted by time, and the (time, agent) pairs of the agents whose paths end in it.
+// So the agents met by a path are found by looking only at the cells of this path.
+class PathTable
+{
+public:
+    PathTable(int height = 0, int width = 0);
+
+    void addAgentPath(const Path &path, int agentId);
+    void removeAgentPath(const Path &path, int agentId);
+    // agents other than agentId that are in the cell at time, sorted by id
+    void getAgents(int cell, int time, int agentId, std::vector<int> &res) const;
+    // pairs (time, agent) for agents other than agentId that are in the cell at some time in [startTime, endTime),
+    // sorted by time and id; an agent that ends its path in the cell is in it at every time from its end
+    void getAgents(int cell, int startTime, int endTime, int agentId, std::vector<std::pair<int, int>> &res) const;
+
+//private:
+    struct CellAgents
+    {
+        std::vector<std::pair<int, int>> nodes;  // (time, agent) before the end of the path of agent
+        std::vector<std::pair<int, int>> goals;  // (time, agent) of the end of the path of agent
+    };
+
+    int getIndex(int cell) const { return Path::unpackI(cell) * width + Path::unpackJ(cell); }
+
+    std::vector<CellAgents> cells;
+    int                     width;
+};
+
+#endif // PATH_TABLE_H
@@ -0,0 +1,293 @@
+#include "perfect_heuristic.h"
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static_assert(sizeof(int) == sizeof(int32_t), "distance tables are stored in the cache as int32_t");
+
+static const char cacheMagic[8] = {'C', 'B', 'S', 'P', 'H', 'C', 0, 0};
+
+void PerfectHeuristic::update(const Map &map, const AgentSet &agentSet, const std::string &cacheDir) {
+    uint64_t hash = getMapHash(map);
+    if (hash != mapHash || map.getMapWidth() != width || map.getMapHeight() != height) {
+        clear();
+        mapHash = hash;
+        width = map.getMapWidth();
+        height = map.getMapHeight();
+        tableByGoal.assign(width * height, nullptr);
+    }
+    cacheFile.clear();
+    if (!cacheDir.empty()) {
+        std::ostringstream name;
+        name << cacheDir << "/" << std::hex << std::setw(16) << std::setfill('0') << mapHash << ".ph";
+        cacheFile = name.str();
+    }
+
+    std::vector<int> goals = getMissingGoals(agentSet);
+    if (!goals.empty() && !cacheFile.empty()) {
+        // other tasks or runs may have stored the missing tables
+        loadCache();
+        goals = getMissingGoals(agentSet);
+    }
+    if (goals.empty()) {
+        return;
+    }
+
+    int firstTable = tables.size();
+    tables.resize(firstTable + goals.size());
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int k = next++; k < int(goals.size()); k = next++) {
+            computeDistances(map, goals[k], tables[firstTable + k]);
+        }
+    };
+    if (goals.size() > 1) {
+        runWorkers(worker);
+    } else {
+        worker();
+    }
+
+    for (int k = 0; k < int(goals.size()); ++k) {
+        tableGoals.push_back(goals[k]);
+        tableByGoal[goals[k]] = tables[firstTable + k].data();
+    }
+    if (!cacheFile.empty()) {
+        saveCache(goals, firstTable);
+    }
+}
+
+PerfectHeuristic::~PerfectHeuristic() {
+    {
+        std::lock_guard<std::mutex> lock(workersMutex);
+        stopWorkers = true;
+    }
+    batchStarted.notify_all();
+    for (auto &thread : workers) {
+        thread.join();
+    }
+}
+
+void PerfectHeuristic::runWorkers(const std::function<void()> &job) {
+    if (workers.empty()) {
+        int workersCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        for (int t = 0; t < workersCount; ++t) {
+            workers.emplace_back(&PerfectHeuristic::workerLoop, this);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(workersMutex);
+        workersJob = &job;
+        busyWorkers = workers.size();
+        ++batch;
+    }
+    batchStarted.notify_all();
+    job();
+    std::unique_lock<std::mutex> lock(workersMutex);
+    batchFinished.wait(lock, [this]() { return busyWorkers == 0; });
+    workersJob = nullptr;
+}
+
+void PerfectHeuristic::workerLoop() {
+    size_t doneBatch = 0;
+    std::unique_lock<std::mutex> lock(workersMutex);
+    while (true) {
+        batchStarted.wait(lock, [this, doneBatch]() { return stopWorkers || batch != doneBatch; });
+        if (stopWorkers) {
+            return;
+        }
+        doneBatch = batch;
+        const std::function<void()> *job = workersJob;
+        lock.unlock();
+        (*job)();
+        lock.lock();
+        if (--busyWorkers == 0) {
+            batchFinished.notify_all();
+        }
+    }
+}
+
+void PerfectHeuristic::clear() {
+    tables.clear();
+    tableGoals.clear();
+    tableByGoal.clear();
+    cacheData.reset();
+    cacheGoalsCount = 0;
+    cacheFile.clear();
+    mapHash = 0;
+    width = 0;
+    height = 0;
+}
+
+uint64_t PerfectHeuristic::getMapHash(const Map &map) {
+    // FNV-1a over the sizes and the obstacles of the grid
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    add(map.getMapWidth());
+    add(map.getMapHeight());
+    for (int i = 0; i < map.getMapHeight(); ++i) {
+        for (int j = 0; j < map.getMapWidth(); ++j) {
+            add(map.CellIsObstacle(i, j));
+        }
+    }
+    return hash;
+}
+
+std::vector<int> PerfectHeuristic::getMissingGoals(const AgentSet &agentSet) const {
+    std::vector<int> goals;
+    for (int i = 0; i < agentSet.getAgentCount(); ++i) {
+        int goal = agentSet.getAgent(i).getGoal_i() * width + agentSet.getAgent(i).getGoal_j();
+        if (tableByGoal[goal] == nullptr && std::find(goals.begin(), goals.end(), goal) == goals.end()) {
+            goals.push_back(goal);
+        }
+    }
+    return goals;
+}
+
+void PerfectHeuristic::computeDistances(const Map &map, int goal, std::vector<int> &distances) {
+    distances.assign(map.getMapHeight() * width, -1);
+    std::vector<int> queue;
+    queue.reserve(map.getEmptyCellCount());
+    distances[goal] = 0;
+    queue.push_back(goal);
+    for (int head = 0; head < int(queue.size()); ++head) {
+        int cell = queue[head], i = cell / width, j = cell % width;
+        for (int di = -1; di <= 1; ++di) {
+            for (int dj = -1; dj <= 1; ++dj) {
+                int newi = i + di, newj = j + dj;
+                if ((di == 0) != (dj == 0) && map.CellOnGrid(newi, newj) && !map.CellIsObstacle(newi, newj) &&
+                        distances[newi * width + newj] == -1) {
+                    distances[newi * width + newj] = distances[cell] + 1;
+                    queue.push_back(newi * width + newj);
+                }
+            }
+        }
+    }
+}
+
+bool PerfectHeuristic::checkHeader(const CacheHeader &header) const {
+    return std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0 && header.version == cacheVersion &&
+           header.mapHash == mapHash && header.width == width && header.height == height && header.goalsCount >= 0;
+}
+
+void PerfectHeuristic::indexTables() {
+    std::fill(tableByGoal.begin(), tableByGoal.end(), nullptr);
+    if (cacheData != nullptr) {
+        size_t recordSize = (1 + size_t(width) * height) * sizeof(int32_t);
+        for (int k = 0; k < cacheGoalsCount; ++k) {
+            const int *record = reinterpret_cast<const int*>(cacheData.get() + sizeof(CacheHeader) + k * recordSize);
+            if (record[0] >= 0 && record[0] < int(tableByGoal.size()) && tableByGoal[record[0]] == nullptr) {
+                tableByGoal[record[0]] = record + 1;
+            }
+        }
+    }
+    for (int k = 0; k < int(tables.size()); ++k) {
+        if (tableByGoal[tableGoals[k]] == nullptr) {
+            tableByGoal[tableGoals[k]] = tables[k].data();
+        }
+    }
+}
+
+void PerfectHeuristic::loadCache() {
+#ifndef _WIN32
+    int fd = open(cacheFile.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    // writers hold an exclusive lock while they append records and update the header, records counted
+    // in the header are complete and never rewritten, so they can be used after the lock is released
+    flock(fd, LOCK_SH);
+    CacheHeader header;
+    struct stat st;
+    if (pread(fd, &header, sizeof(header), 0) == sizeof(header) && checkHeader(header) && fstat(fd, &st) == 0) {
+        size_t size = st.st_size;
+        size_t recordSize = (1 + size_t(width) * height) * sizeof(int32_t);
+        void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED) {
+            cacheData = std::shared_ptr<const char>(static_cast<const char*>(data),
+                                                    [size](const char *p) { munmap((void*)p, size); });
+            cacheGoalsCount = std::min<size_t>(header.goalsCount, (size - sizeof(CacheHeader)) / recordSize);
+        }
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+    indexTables();
+#endif
+}
+
+bool PerfectHeuristic::writeRecords(int fd, int64_t offset, const std::vector<int> &goals, int firstTable) const {
+#ifndef _WIN32
+    size_t tableSize = size_t(width) * height * sizeof(int32_t);
+    for (int k = 0; k < int(goals.size()); ++k) {
+        if (pwrite(fd, &goals[k], sizeof(int32_t), offset) != sizeof(int32_t) ||
+                pwrite(fd, tables[firstTable + k].data(), tableSize, offset + sizeof(int32_t)) != ssize_t(tableSize)) {
+            return false;
+        }
+        offset += sizeof(int32_t) + tableSize;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PerfectHeuristic::saveCache(const std::vector<int> &goals, int firstTable) {
+#ifndef _WIN32
+    int fd = open(cacheFile.c_str(), O_RDWR);
+    CacheHeader header;
+    bool valid = false;
+    if (fd != -1) {
+        flock(fd, LOCK_EX);
+        struct stat fileStat, pathStat;
+        // the file may have been replaced while we were waiting for the lock
+        valid = fstat(fd, &fileStat) == 0 && stat(cacheFile.c_str(), &pathStat) == 0 &&
+                fileStat.st_ino == pathStat.st_ino && fileStat.st_dev == pathStat.st_dev &&
+                pread(fd, &header, sizeof(header), 0) == sizeof(header) && checkHeader(header);
+    }
+    bool success;
+    if (valid) {
+        // records are written after the last one in the header, so a partially written record is overwritten
+        off_t offset = sizeof(header) + off_t(header.goalsCount) * (1 + size_t(width) * height) * sizeof(int32_t);
+        success = writeRecords(fd, offset, goals, firstTable);
+        if (success) {
+            header.goalsCount += goals.size();
+            success = pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+        }
+    } else {
+        // other processes may have the old file mapped, so it is replaced by a new one instead of being rewritten
+        std::string tmpFile = cacheFile + ".tmp" + std::to_string(getpid());
+        int tmpFd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.mapHash = mapHash;
+        header.version = cacheVersion;
+        header.width = width;
+        header.height = height;
+        header.goalsCount = goals.size();
+        success = tmpFd != -1 && pwrite(tmpFd, &header, sizeof(header), 0) == sizeof(header) &&
+                  writeRecords(tmpFd, sizeof(header), goals, firstTable);
+        if (tmpFd != -1) {
+            success = close(tmpFd) == 0 && success;
+            success = success && rename(tmpFile.c_str(), cacheFile.c_str()) == 0;
+            if (!success) {
+                unlink(tmpFile.c_str());
+            }
+        }
+    }
+    if (!success) {
+        std::cout << "Warning! Can't write heuristic cache file '" << cacheFile << "'." << std::endl;
+    }
+    if (fd != -1) {
+        flock(fd, LOCK_UN);
+        close(fd);
+    }
+#endif
+}
@@ -0,0 +1,86 @@
+#ifndef PERFECTHEURISTIC_H
+#define PERFECTHEURISTIC_H
+
+#include "map.h"
+#include "agent_set.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Exact distances to the goals of the agents on 4-connected grid, computed by BFS from every goal.
+// Every distinct goal cell has one dense table indexed by cell id (i * width + j), agents with the same goal share it.
+// Tables are added lazily for new goals and kept while the map stays the same. Missing tables are built in parallel
+// by the calling thread and a pool of workers that lives as long as the heuristic; they take goals from a shared
+// counter. With a cache directory tables are also stored in a binary file named by the hash of the grid:
+// the file is memory-mapped by later tasks and runs and new tables are appended to it under a file lock, a file with
+// a wrong header is replaced through a rename, never rewritten in place (POSIX only).
+class PerfectHeuristic
+{
+public:
+    PerfectHeuristic() = default;
+    PerfectHeuristic(const PerfectHeuristic &) = delete;
+    PerfectHeuristic &operator=(const PerfectHeuristic &) = delete;
+    ~PerfectHeuristic();
+
+    void update(const Map &map, const AgentSet &agentSet, const std::string &cacheDir = "");
+    bool empty() const { return tableByGoal.empty(); }
+    void clear();
+
+    // distance from (i, j) to (goal_i, goal_j), -1 if goal has no table or (i, j) is unreachable from it
+    int getDistance(int i, int j, int goal_i, int goal_j) const {
+        if (tableByGoal.empty()) {
+            return -1;
+        }
+        const int *table = tableByGoal[goal_i * width + goal_j];
+        return table == nullptr ? -1 : table[i * width + j];
+    }
+
+//private:
+    static const uint32_t cacheVersion = 1;
+
+    struct CacheHeader
+    {
+        char        magic[8];
+        uint64_t    mapHash;
+        uint32_t    version;
+        int32_t     width, height;
+        int32_t     goalsCount;
+    };
+
+    static uint64_t getMapHash(const Map &map);
+    std::vector<int> getMissingGoals(const AgentSet &agentSet) const;
+    void computeDistances(const Map &map, int goal, std::vector<int> &distances);
+    bool checkHeader(const CacheHeader &header) const;
+    void loadCache();
+    void saveCache(const std::vector<int> &goals, int firstTable);
+    bool writeRecords(int fd, int64_t offset, const std::vector<int> &goals, int firstTable) const;
+    void indexTables();
+    void runWorkers(const std::function<void()> &job);
+    void workerLoop();
+
+    std::vector<std::vector<int>>   tables;
+    std::vector<int>                tableGoals;
+    std::vector<const int*>         tableByGoal;
+    std::shared_ptr<const char>     cacheData;
+    int                             cacheGoalsCount = 0;
+    std::string                     cacheFile;
+    uint64_t                        mapHash = 0;
+    int                             width = 0;
+    int                             height = 0;
+
+    // workers run the job of every batch once, the caller waits until all of them are done
+    std::vector<std::thread>        workers;
+    std::mutex                      workersMutex;
+    std::condition_variable         batchStarted, batchFinished;
+    const std::function<void()>     *workersJob = nullptr;
+    size_t                          batch = 0;
+    int                             busyWorkers = 0;
+    bool                            stopWorkers = false;
+};
+
+#endif // PERFECTHEURISTIC_H
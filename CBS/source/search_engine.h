@@ -0,0 +1,58 @@
+#ifndef SEARCHENGINE_H
+#define SEARCHENGINE_H
+
+#include "isearch.h"
+
+// Low level search composed at compile time. SearchType fixes the node layout (NodeType),
+// OPEN and FOCAL queues (QueueType, FocalQueueType), the heuristic (Astar) and the focal rules (FocalSearch),
+// e.g. SearchEngine<FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>>.
+// The class is final, so the hooks of SearchType called from the search loop are bound statically
+// and can be inlined. Successors are generated by ISearch, so SearchType must not override findSuccessors.
+template <typename SearchType>
+class SearchEngine final : public SearchType
+{
+public:
+    typedef typename SearchType::SearchNodeType NodeType;
+
+    using SearchType::SearchType;
+
+    SearchResult startSearch(const Map &map, const AgentSet &agentSet,
+                             int start_i, int start_j, int goal_i = 0, int goal_j = 0,
+                             bool (*isGoal)(const Node&, const Node&, const Map&, const AgentSet&) = nullptr,
+                             bool freshStart = true, bool returnPath = true,
+                             int startTime = 0, int goalTime = -1, int maxTime = -1,
+                             const std::unordered_set<Node> &occupiedNodes =
+                                   std::unordered_set<Node>(),
+                             const ConstraintsSet &constraints = ConstraintsSet(),
+                             bool withCAT = false, const ConflictAvoidanceTable &CAT = ConflictAvoidanceTable(),
+                             std::chrono::steady_clock::time_point globalBegin = std::chrono::steady_clock::time_point(),
+                             int globalTimeLimit = -1) {
+        return this->runSearch(*this, map, agentSet, start_i, start_j, goal_i, goal_j, isGoal, freshStart, returnPath,
+                               startTime, goalTime, maxTime, occupiedNodes, constraints, withCAT, CAT,
+                               globalBegin, globalTimeLimit);
+    }
+
+    using SearchType::findSuccessors;
+    void findSuccessors(const NodeType &curNode, const Map &map, SuccessorBuffer<NodeType> &successors,
+                        int goal_i = 0, int goal_j = 0, int agentId = -1,
+                        const std::unordered_set<Node> &occupiedNodes =
+                              std::unordered_set<Node>(),
+                        const ConstraintsSet &constraints = ConstraintsSet(),
+                        bool withCAT = false, const ConflictAvoidanceTable &CAT = ConflictAvoidanceTable()) override {
+        this->generateSuccessors(*this, curNode, map, successors, goal_i, goal_j, agentId,
+                                 occupiedNodes, constraints, withCAT, CAT);
+    }
+
+    // hooks called by ISearch::runSearch, some of them are protected in SearchType
+    using SearchType::checkOpenEmpty;
+    using SearchType::getCur;
+    using SearchType::removeCur;
+    using SearchType::updateFocal;
+    using SearchType::getFocalSize;
+    using SearchType::getMinFocalF;
+    using SearchType::subtractFutureConflicts;
+    using SearchType::setHC;
+    using SearchType::addStartNode;
+};
+
+#endif // SEARCHENGINE_H
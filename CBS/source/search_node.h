@@ -0,0 +1,70 @@
+#ifndef SEARCH_NODE_H
+#define SEARCH_NODE_H
+
+#include <cstddef>
+#include <type_traits>
+#include "node.h"
+
+// Compact node of the low level search: no vtable, integer costs, trivially copyable.
+// Has the fields of both Node and FSNode, so it can be used by Astar and FocalSearch.
+// Parent is an index into the CLOSE pool of the search that created the node, -1 for the start node.
+// Converted to Node only when the path is built and for the isGoal callback.
+struct SearchNode
+{
+    int     i, j;
+    int     g, F, H;
+    int     conflictsCount;
+    int     hc, futureConflictsCount;
+    int     parent;
+
+    // parent is always set by the search, the pointer argument keeps the signature of Node constructor
+    SearchNode(int x = 0, int y = 0, std::nullptr_t = nullptr, int g_ = 0, double H_ = 0, int ConflictsCount = 0) :
+        i(x), j(y), g(g_), F(g_ == CN_INFINITY ? g_ : g_ + int(H_)), H(H_), conflictsCount(ConflictsCount),
+        hc(0), futureConflictsCount(0), parent(-1) {}
+
+    bool operator== (const SearchNode &other) const {
+        return i == other.i && j == other.j;
+    }
+    bool operator!= (const SearchNode &other) const {
+        return i != other.i || j != other.j;
+    }
+    // same order as FSNode, with zero hc it is the order of Node
+    bool operator< (const SearchNode &other) const {
+        if (F != other.F) return F < other.F;
+        if (g != other.g) return g > other.g;
+        if (hc != other.hc) return hc < other.hc;
+        if (i != other.i) return i < other.i;
+        return j < other.j;
+    }
+
+    int convolution(int width, int height, bool withTime = false) const {
+        int res = withTime ? width * height * g : 0;
+        return res + i * width + j;
+    }
+
+    int getHC() const {
+        return hc;
+    }
+
+    operator Node() const {
+        return Node(i, j, nullptr, g, H, conflictsCount);
+    }
+};
+
+static_assert(std::is_trivially_copyable<SearchNode>::value, "SearchNode must be trivially copyable");
+
+inline int getTimeLayer(const SearchNode &node) {
+    return node.g;
+}
+
+// Links node to its parent, which was closed at parentIndex of the CLOSE pool:
+// Node keeps a pointer, SearchNode keeps the index
+inline void setParent(Node &node, Node *parent, int) {
+    node.parent = parent;
+}
+
+inline void setParent(SearchNode &node, SearchNode *, int parentIndex) {
+    node.parent = parentIndex;
+}
+
+#endif // SEARCH_NODE_H
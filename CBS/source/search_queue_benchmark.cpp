@@ -0,0 +1,98 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include "map.h"
+#include "agent_set.h"
+#include "astar.h"
+#include "focalsearch.h"
+#include "search_engine.h"
+
+// Compares OPEN implementations, the devirtualized SearchEngine and SearchNode layout of the low level search on a grid workload:
+// every agent from the agents file is planned with plain A*, with time-expanded A* and
+// with time-expanded focal search, the last two avoiding paths of previous agents through CAT.
+// Usage: SearchQueueBenchmark <task.xml> <agents.xml> [repeats]
+
+template<typename SearchType>
+void runBenchmark(const std::string &name, const Map &map, const AgentSet &agentSet,
+                  SearchType search, bool withCAT, int repeats, std::vector<int> &lengths)
+{
+    long long expansions = 0;
+    std::vector<int> res;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        ConflictAvoidanceTable CAT;
+        for (int i = 0; i < agentSet.getAgentCount(); ++i) {
+            Agent agent = agentSet.getAgent(i);
+            SearchResult sr = search.startSearch(map, agentSet, agent.getStart_i(), agent.getStart_j(),
+                                                 agent.getGoal_i(), agent.getGoal_j(), nullptr,
+                                                 true, true, 0, -1, -1, {}, {}, withCAT, CAT);
+            expansions += sr.nodesexpanded;
+            if (r == 0) {
+                res.push_back(sr.pathfound ? sr.pathlength : -1);
+            }
+            if (withCAT && sr.pathfound) {
+                CAT.addAgentPath(Path(sr.lppath->begin(), sr.lppath->end()));
+            }
+        }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0;
+    std::cout << std::left << std::setw(32) << name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(1) << ms << " ms" << std::setw(14) << expansions << " expansions";
+    if (!lengths.empty()) {
+        std::cout << (lengths == res ? "" : "  (path lengths differ!)");
+    }
+    std::cout << std::endl;
+    lengths = res;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <task.xml> <agents.xml> [repeats]" << std::endl;
+        return 0;
+    }
+    Map map;
+    AgentSet agentSet;
+    if (!map.getMap(argv[1]) || !agentSet.readAgents(argv[2])) {
+        return 1;
+    }
+    int repeats = argc > 3 ? std::stoi(argv[3]) : 1;
+
+    std::vector<int> lengths;
+    runBenchmark("A*, SearchQueue", map, agentSet, Astar<Node, SearchQueue<Node>>(false), false, repeats, lengths);
+    runBenchmark("A*, IndexedHeapQueue", map, agentSet, Astar<Node, IndexedHeapQueue<Node>>(false), false, repeats, lengths);
+    runBenchmark("A*, BucketQueue", map, agentSet, Astar<Node, BucketQueue<Node>>(false), false, repeats, lengths);
+
+    lengths.clear();
+    runBenchmark("A* + time, SearchQueue", map, agentSet,
+                 Astar<Node, SearchQueue<Node>>(true), true, repeats, lengths);
+    runBenchmark("A* + time, IndexedHeapQueue", map, agentSet,
+                 Astar<Node, IndexedHeapQueue<Node>>(true), true, repeats, lengths);
+    runBenchmark("A* + time, BucketQueue", map, agentSet,
+                 Astar<Node, BucketQueue<Node>>(true), true, repeats, lengths);
+    runBenchmark("A* + time, SearchEngine", map, agentSet,
+                 SearchEngine<Astar<Node, BucketQueue<Node>>>(true), true, repeats, lengths);
+    runBenchmark("A* + time, SearchNode", map, agentSet,
+                 SearchEngine<Astar<SearchNode, BucketQueue<SearchNode>>>(true), true, repeats, lengths);
+
+    lengths.clear();
+    runBenchmark("Focal + time, SearchQueue", map, agentSet,
+                 FocalSearch<FSNode, SearchQueue<FSNode>>(true, 1.5), true, repeats, lengths);
+    runBenchmark("Focal + time, IndexedHeapQueue", map, agentSet,
+                 FocalSearch<FSNode, IndexedHeapQueue<FSNode>>(true, 1.5), true, repeats, lengths);
+    runBenchmark("Focal + time, BucketQueue", map, agentSet,
+                 FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>(true, 1.5), true, repeats, lengths);
+    runBenchmark("Focal + time, SearchEngine", map, agentSet,
+                 SearchEngine<FocalSearch<FSNode, BucketQueue<FSNode>, IndexedHeapQueue<FSNode>>>(true, 1.5),
+                 true, repeats, lengths);
+    runBenchmark("Focal + time, SearchNode", map, agentSet,
+                 SearchEngine<FocalSearch<SearchNode, BucketQueue<SearchNode>, IndexedHeapQueue<SearchNode>>>(true, 1.5),
+                 true, repeats, lengths);
+    runBenchmark("Focal + time, FocalQueue", map, agentSet,
+                 FocalSearch<FSNode, FocalQueue<FSNode>>(true, 1.5), true, repeats, lengths);
+    runBenchmark("Focal + time, FocalQueue engine", map, agentSet,
+                 SearchEngine<FocalSearch<SearchNode, FocalQueue<SearchNode>>>(true, 1.5), true, repeats, lengths);
+    return 0;
+}
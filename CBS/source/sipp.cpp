@@ -0,0 +1,51 @@
+#include "sipp.h"
+
+template<typename NodeType, typename QueueType>
+SIPP<NodeType, QueueType>::SIPP(double HW, bool BT) :
+    Astar<NodeType, QueueType>(true, HW, BT) {}
+
+template<typename NodeType, typename QueueType>
+void SIPP<NodeType, QueueType>::setEndTime(NodeType& node, int start_i, int start_j, int startTime,
+                                           int agentId, const ConstraintsSet &constraints) {
+    node.startTime = startTime;
+    node.endTime = startTime;
+    for (auto interval : constraints.getSafeIntervals(start_i, start_j, agentId, startTime, startTime)) {
+        if (interval.first <= startTime && startTime <= interval.second) {
+            node.startTime = interval.first;
+            node.endTime = interval.second;
+        }
+    }
+}
+
+template<typename NodeType, typename QueueType>
+void SIPP<NodeType, QueueType>::createSuccessorsFromNode(const NodeType &cur, NodeType &neigh,
+                                                         SuccessorBuffer<NodeType> &successors,
+                                                         int agentId, const ConstraintsSet &constraints,
+                                                         const ConflictAvoidanceTable &CAT, bool isGoal) {
+    // the agent may leave the cell at any moment of its interval
+    int lastArrival = cur.endTime == CN_INFINITY ? CN_INFINITY : cur.endTime + 1;
+    for (auto interval : constraints.getSafeIntervals(neigh.i, neigh.j, agentId, cur.g + 1, lastArrival)) {
+        int time = std::max(cur.g + 1, interval.first);
+        int endTime = std::min(lastArrival, interval.second);
+        while (time <= endTime && constraints.hasEdgeConstraint(neigh.i, neigh.j, time, agentId, cur.i, cur.j)) {
+            ++time;
+        }
+        if (time > endTime) {
+            continue;
+        }
+        NodeType succ(neigh.i, neigh.j, nullptr, time, neigh.H,
+                      CAT.getAgentsCount(neigh.i, neigh.j, time, cur.i, cur.j));
+        succ.startTime = interval.first;
+        succ.endTime = interval.second;
+        this->setHC(succ, cur, CAT, isGoal);
+        successors.push_back(succ);
+    }
+}
+
+template<typename NodeType, typename QueueType>
+bool SIPP<NodeType, QueueType>::checkGoal(const NodeType &cur, int goalTime, int, const ConstraintsSet &) {
+    // the agent waits in the goal until goalTime
+    return goalTime == -1 || (cur.g <= goalTime && goalTime <= cur.endTime);
+}
+
+template class SIPP<SIPPNode, BucketQueue<SIPPNode>>;
@@ -0,0 +1,32 @@
+#ifndef SIPP_H
+#define SIPP_H
+#include "astar.h"
+#include "sipp_node.h"
+
+// Safe Interval Path Planning, discrete version for 4-connected grid.
+// Search state is a cell and one of its safe intervals (maximal periods free of vertex constraints),
+// a successor is the earliest arrival to a safe interval of a neighbour cell, waiting happens implicitly before the move.
+// Edge constraints postpone the arrival inside the interval, goal constraints shorten the last interval of the cell.
+// The search always runs in time, so unlike Astar it has no WithTime flag.
+// Costs of found paths are the same as of Astar with time, the number of expanded states does not grow with waits.
+template <typename NodeType = SIPPNode, typename QueueType = BucketQueue<NodeType>>
+class SIPP : public Astar<NodeType, QueueType>
+{
+public:
+    SIPP(double HW = 1.0, bool BT = true);
+    SIPP(SIPP& other) = default;
+    SIPP& operator=(SIPP& other) = default;
+    SIPP(SIPP&& other) = default;
+    SIPP& operator=(SIPP&& other) = default;
+    virtual ~SIPP() = default;
+
+    void setEndTime(NodeType& node, int start_i, int start_j, int startTime,
+                    int agentId, const ConstraintsSet &constraints) override;
+    void createSuccessorsFromNode(const NodeType &cur, NodeType &neigh, SuccessorBuffer<NodeType> &successors,
+                                  int agentId, const ConstraintsSet &constraints,
+                                  const ConflictAvoidanceTable &CAT, bool isGoal) override;
+    bool checkGoal(const NodeType &cur, int goalTime, int agentId, const ConstraintsSet &constraints) override;
+    bool canStay() override { return false; }
+};
+
+#endif // SIPP_H
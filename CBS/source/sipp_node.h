@@ -0,0 +1,49 @@
+#ifndef SIPP_NODE_H
+#define SIPP_NODE_H
+
+#include <vector>
+#include "search_node.h"
+#include "successor_buffer.h"
+
+// Node of SIPP: the agent is in cell (i, j) during safe interval [startTime, endTime] and arrived there at g.
+// States are identified by the cell and the start of the interval, so OPEN and CLOSE key nodes by startTime instead of g.
+struct SIPPNode : public SearchNode
+{
+    int     startTime, endTime;
+
+    SIPPNode(int x = 0, int y = 0, std::nullptr_t = nullptr, int g_ = 0, double H_ = 0, int ConflictsCount = 0) :
+        SearchNode(x, y, nullptr, g_, H_, ConflictsCount), startTime(g_), endTime(CN_INFINITY) {}
+
+    int convolution(int width, int height, bool withTime = false) const {
+        int res = withTime ? width * height * startTime : 0;
+        return res + i * width + j;
+    }
+};
+
+static_assert(std::is_trivially_copyable<SIPPNode>::value, "SIPPNode must be trivially copyable");
+
+inline int getTimeLayer(const SIPPNode &node) {
+    return node.startTime;
+}
+
+// A node of SIPP has a successor for every safe interval of a neighbour cell reachable before the end of its own interval,
+// so their number is not bounded by the moves
+template <>
+class SuccessorBuffer<SIPPNode>
+{
+public:
+    void push_back(const SIPPNode &node) { nodes.push_back(node); }
+    void clear() { nodes.clear(); }
+    int size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+
+    SIPPNode* begin() { return nodes.data(); }
+    SIPPNode* end() { return nodes.data() + nodes.size(); }
+    const SIPPNode* begin() const { return nodes.data(); }
+    const SIPPNode* end() const { return nodes.data() + nodes.size(); }
+
+//private:
+    std::vector<SIPPNode>   nodes;
+};
+
+#endif // SIPP_NODE_H
@@ -0,0 +1,29 @@
+#ifndef SUCCESSORBUFFER_H
+#define SUCCESSORBUFFER_H
+
+#include "node.h"
+
+// Fixed-capacity inline list of successors of a single expansion: four moves and wait action.
+// Lives on the stack of the caller, so generating successors does not touch the heap.
+template <typename NodeType = Node>
+class SuccessorBuffer
+{
+public:
+    static const int capacity = 5;
+
+    void push_back(const NodeType &node) { nodes[count++] = node; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    NodeType* begin() { return nodes; }
+    NodeType* end() { return nodes + count; }
+    const NodeType* begin() const { return nodes; }
+    const NodeType* end() const { return nodes + count; }
+
+//private:
+    NodeType    nodes[capacity];
+    int         count = 0;
+};
+
+#endif // SUCCESSORBUFFER_H
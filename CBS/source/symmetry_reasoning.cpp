@@ -0,0 +1,254 @@
+#include "symmetry_reasoning.h"
+
+const int SymmetryReasoning::moveOffsets[4][2] = {{-1, 0}, {0, -1}, {0, 1}, {1, 0}};
+
+bool SymmetryReasoning::getCorridorConstraints(const Map &map, const Conflict &conflict,
+                                               const Path &path1, const Path &path2,
+                                               Constraint &constraint1, Constraint &constraint2) {
+    Node node = conflict.pos1;
+    if (map.getCellDegree(node.i, node.j) != 2) {
+        node = conflict.pos2;
+        if (map.getCellDegree(node.i, node.j) != 2) {
+            return false;
+        }
+    }
+    std::vector<int> corridor;
+    int end1, end2;
+    if (!getCorridor(map, Path::packCell(node.i, node.j), corridor, end1, end2)) {
+        return false;
+    }
+
+    int entry1, exit1, entry2, exit2;
+    if (!getCorridorPassage(path1, corridor, conflict.time, entry1, exit1) ||
+            !getCorridorPassage(path2, corridor, conflict.time, entry2, exit2) ||
+            entry1 != exit2 || exit1 != entry2) {
+        return false;
+    }
+
+    // An agent that reaches its exit earlier than it can go around the corridor has passed it. If both pass it,
+    // one of them enters it after the other one has left, so it reaches its exit at least length steps
+    // after the earliest time the other one reaches its exit. Distances without constraints are lower bounds
+    // of these times, so the split stays sound with them.
+    int length = corridor.size() + 1;
+    int start1 = path1.getCell(0), start2 = path2.getCell(0);
+    int time1 = getDistance(map, start1, exit1), time2 = getDistance(map, start2, exit2);
+    int maxTime1 = std::min(getDistance(map, start1, exit1, corridor) - 1, time2 + length - 1);
+    int maxTime2 = std::min(getDistance(map, start2, exit2, corridor) - 1, time1 + length - 1);
+
+    int visit1 = getFirstVisit(path1, exit1), visit2 = getFirstVisit(path2, exit2);
+    if (visit1 == -1 || visit1 > maxTime1 || visit2 == -1 || visit2 > maxTime2) {
+        return false;
+    }
+    constraint1 = Constraint(Path::unpackI(exit1), Path::unpackJ(exit1), 1, conflict.id1);
+    constraint1.dur = maxTime1;
+    constraint2 = Constraint(Path::unpackI(exit2), Path::unpackJ(exit2), 1, conflict.id2);
+    constraint2.dur = maxTime2;
+    return true;
+}
+
+int SymmetryReasoning::getRectangleConstraints(const Conflict &conflict, const Path &path1, const Path &path2,
+                                               const MDD &mdd1, const MDD &mdd2,
+                                               Constraint &constraint1, Constraint &constraint2) {
+    int time = conflict.time, cell = Path::packCell(conflict.pos1.i, conflict.pos1.j);
+    if (conflict.edgeConflict || time >= path1.size() || time >= path2.size() ||
+            getManhattanDistance(path1.getCell(0), cell) != time ||
+            getManhattanDistance(path2.getCell(0), cell) != time) {
+        return 0;
+    }
+
+    // the prefixes of the paths that are shortest paths, they never come closer to the start along an axis
+    auto getPrefixEnd = [](const Path &path) {
+        int res = 0;
+        while (res + 1 < path.size() && getManhattanDistance(path.getCell(0), path.getCell(res + 1)) == res + 1) {
+            ++res;
+        }
+        return res;
+    };
+    int prefixEnd1 = getPrefixEnd(path1), prefixEnd2 = getPrefixEnd(path2);
+
+    // the grid is mirrored so that both agents go down and right
+    auto getDirection = [](int delta1, int delta2) {
+        if (delta1 != 0 && delta2 != 0 && (delta1 > 0) != (delta2 > 0)) {
+            return 0;
+        }
+        return delta1 < 0 || delta2 < 0 ? -1 : 1;
+    };
+    int di = getDirection(path1.getI(prefixEnd1) - path1.getI(0), path2.getI(prefixEnd2) - path2.getI(0));
+    int dj = getDirection(path1.getJ(prefixEnd1) - path1.getJ(0), path2.getJ(prefixEnd2) - path2.getJ(0));
+    if (di == 0 || dj == 0) {
+        return 0;
+    }
+    std::vector<std::pair<int, int>> prefix1, prefix2;
+    for (int t = 0; t <= prefixEnd1; ++t) {
+        prefix1.emplace_back(di * path1.getI(t), dj * path1.getJ(t));
+    }
+    for (int t = 0; t <= prefixEnd2; ++t) {
+        prefix2.emplace_back(di * path2.getI(t), dj * path2.getJ(t));
+    }
+
+    // Both agents are at the conflict cell at the Manhattan distance from their starts, so the starts
+    // are on one antidiagonal and the agents get to every cell on shortest paths at the same time.
+    // The upper one enters the rectangle from its top border, the other one from its left border.
+    bool swapped = prefix1[0].first > prefix2[0].first;
+    const auto &top = swapped ? prefix2 : prefix1, &left = swapped ? prefix1 : prefix2;
+    int startI = left[0].first, startJ = top[0].second;
+    int conflictI = di * conflict.pos1.i, conflictJ = dj * conflict.pos1.j;
+    int maxI = std::min(top.back().first, left.back().first), maxJ = std::min(top.back().second, left.back().second);
+
+    // the column where the top agent first gets to every row and the row where the left one first gets to every column
+    std::vector<int> columns(maxI - conflictI + 1, -1), rows(maxJ - conflictJ + 1, -1);
+    for (auto &pos : top) {
+        if (pos.first >= conflictI && pos.first <= maxI && columns[pos.first - conflictI] == -1) {
+            columns[pos.first - conflictI] = pos.second;
+        }
+    }
+    for (auto &pos : left) {
+        if (pos.second >= conflictJ && pos.second <= maxJ && rows[pos.second - conflictJ] == -1) {
+            rows[pos.second - conflictJ] = pos.first;
+        }
+    }
+
+    // the largest rectangle with the far borders crossed by both paths, the conflict cell is always one of them
+    int endI = -1, endJ = -1, maxArea = 0;
+    for (int i = conflictI; i <= maxI; ++i) {
+        for (int j = conflictJ; j <= maxJ; ++j) {
+            int area = (i - startI + 1) * (j - startJ + 1);
+            if (columns[i - conflictI] <= j && rows[j - conflictJ] <= i && area > maxArea) {
+                endI = i;
+                endJ = j;
+                maxArea = area;
+            }
+        }
+    }
+    if ((endI == startI && endJ == startJ) || endI == top[0].first || endJ == left[0].second) {
+        return 0;
+    }
+
+    auto getBarrier = [di, dj](int i, int j, int lastI, int lastJ, int time, int agentId) {
+        Constraint res(di * i, dj * j, time, agentId);
+        res.end_i = di * lastI;
+        res.end_j = dj * lastJ;
+        return res;
+    };
+    Constraint topBarrier = getBarrier(endI, startJ, endI, endJ, endI - top[0].first,
+                                       swapped ? conflict.id2 : conflict.id1);
+    Constraint leftBarrier = getBarrier(startI, endJ, endI, endJ, endJ - left[0].second,
+                                        swapped ? conflict.id1 : conflict.id2);
+    constraint1 = swapped ? leftBarrier : topBarrier;
+    constraint2 = swapped ? topBarrier : leftBarrier;
+    return !MDD(mdd1, constraint1).hasPaths() + !MDD(mdd2, constraint2).hasPaths();
+}
+
+void SymmetryReasoning::clear() {
+    distances.clear();
+}
+
+bool SymmetryReasoning::getCorridor(const Map &map, int cell, std::vector<int> &corridor, int &end1, int &end2) {
+    auto getNeighbours = [&map](int cur) {
+        std::vector<int> res;
+        for (auto &offset : moveOffsets) {
+            int i = Path::unpackI(cur) + offset[0], j = Path::unpackJ(cur) + offset[1];
+            if (map.CellOnGrid(i, j) && !map.CellIsObstacle(i, j)) {
+                res.push_back(Path::packCell(i, j));
+            }
+        }
+        return res;
+    };
+
+    corridor = {cell};
+    std::vector<int> ends;
+    for (int next : getNeighbours(cell)) {
+        int prev = cell, cur = next;
+        while (map.getCellDegree(Path::unpackI(cur), Path::unpackJ(cur)) == 2) {
+            if (cur == cell) {
+                return false;
+            }
+            corridor.push_back(cur);
+            std::vector<int> neighbours = getNeighbours(cur);
+            int following = neighbours[0] == prev ? neighbours[1] : neighbours[0];
+            prev = cur;
+            cur = following;
+        }
+        ends.push_back(cur);
+    }
+    std::sort(corridor.begin(), corridor.end());
+    end1 = ends[0];
+    end2 = ends[1];
+    return end1 != end2;
+}
+
+bool SymmetryReasoning::getCorridorPassage(const Path &path, const std::vector<int> &corridor, int time,
+                                           int &entry, int &exit) {
+    auto inCorridor = [&](int t) {
+        return std::binary_search(corridor.begin(), corridor.end(), path.getCell(t));
+    };
+    if (!inCorridor(time)) {
+        --time;
+        if (time < 0 || !inCorridor(time)) {
+            return false;
+        }
+    }
+    int first = time, last = time;
+    while (first >= 0 && inCorridor(first)) {
+        --first;
+    }
+    while (last < path.size() && inCorridor(last)) {
+        ++last;
+    }
+    if (first < 0 || last >= path.size()) {
+        return false;
+    }
+    entry = path.getCell(first);
+    exit = path.getCell(last);
+    return entry != exit;
+}
+
+int SymmetryReasoning::getDistance(const Map &map, int cell, int target, const std::vector<int> &corridor) {
+    int width = map.getMapWidth();
+    auto getIndex = [width](int cell) {
+        return Path::unpackI(cell) * width + Path::unpackJ(cell);
+    };
+    uint64_t key = uint64_t(target) << 32 | (corridor.empty() ? 0 : uint64_t(corridor[0]) + 1);
+    auto it = distances.find(key);
+    if (it != distances.end()) {
+        return it->second[getIndex(cell)];
+    }
+
+    std::vector<int> &res = distances[key];
+    res.assign(map.getMapHeight() * width, CN_INFINITY);
+    std::vector<bool> blocked(res.size(), false);
+    for (int cur : corridor) {
+        blocked[getIndex(cur)] = true;
+    }
+    std::vector<int> queue = {target};
+    res[getIndex(target)] = 0;
+    for (int k = 0; k < int(queue.size()); ++k) {
+        int i = Path::unpackI(queue[k]), j = Path::unpackJ(queue[k]);
+        int dist = res[getIndex(queue[k])];
+        for (auto &offset : moveOffsets) {
+            int next_i = i + offset[0], next_j = j + offset[1];
+            if (!map.CellOnGrid(next_i, next_j) || map.CellIsObstacle(next_i, next_j)) {
+                continue;
+            }
+            int next = Path::packCell(next_i, next_j);
+            if (!blocked[getIndex(next)] && res[getIndex(next)] == CN_INFINITY) {
+                res[getIndex(next)] = dist + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+    return res[getIndex(cell)];
+}
+
+int SymmetryReasoning::getFirstVisit(const Path &path, int cell) {
+    for (int time = 1; time < path.size(); ++time) {
+        if (path.getCell(time) == cell) {
+            return time;
+        }
+    }
+    return -1;
+}
+
+int SymmetryReasoning::getManhattanDistance(int cell1, int cell2) {
+    return std::abs(Path::unpackI(cell1) - Path::unpackI(cell2)) + std::abs(Path::unpackJ(cell1) - Path::unpackJ(cell2));
+}
@@ -0,0 +1,56 @@
+#ifndef SYMMETRY_REASONING_H
+#define SYMMETRY_REASONING_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "map.h"
+#include "agent_set.h"
+#include "conflict_set.h"
+#include "constraint.h"
+#include "path.h"
+#include "mdd.h"
+
+// Symmetric conflicts of two agents, for which the usual split has to be repeated for every pair of
+// paths of the same cost the agents have, are resolved by one split with range or barrier constraints.
+// Every solution satisfies one of the two constraints, so the split keeps all solutions, and the current
+// paths of both agents violate them. Both reasonings rely on the agents starting at time 0 in their starts,
+// so they are not used for agents with positive constraints.
+class SymmetryReasoning
+{
+public:
+    // Agents that go through a corridor (a chain of cells of degree 2) in opposite directions: agent 1 is not allowed
+    // to be in the exit e2 of the corridor until one of them could pass it after the other one or go around it,
+    // agent 2 the same for its exit e1. False if the conflict is not such one.
+    bool getCorridorConstraints(const Map &map, const Conflict &conflict, const Path &path1, const Path &path2,
+                                Constraint &constraint1, Constraint &constraint2);
+    // Agents that cross a rectangle by shortest paths, one from its top border to the bottom one and the other
+    // from its left border to the right one, arriving at every cell at the same time: then their paths meet,
+    // so one of them is not allowed to reach the far border of its crossing in the shortest time.
+    // Returns the number of agents whose MDDs have no paths under their barriers, 0 if the conflict is not such one.
+    int getRectangleConstraints(const Conflict &conflict, const Path &path1, const Path &path2,
+                                const MDD &mdd1, const MDD &mdd2, Constraint &constraint1, Constraint &constraint2);
+    void clear();
+
+//private:
+    static const int moveOffsets[4][2];
+
+    // cells of the corridor through the cell and the cells at its ends, false if there is none
+    static bool getCorridor(const Map &map, int cell, std::vector<int> &corridor, int &end1, int &end2);
+    // entry and exit of the corridor of the agent that is in it at time or time - 1, false if it starts or ends in it
+    static bool getCorridorPassage(const Path &path, const std::vector<int> &corridor, int time,
+                                   int &entry, int &exit);
+    // distance from the cell to the target, with the cells of the corridor as obstacles if it is given,
+    // CN_INFINITY if there is no path
+    int getDistance(const Map &map, int cell, int target, const std::vector<int> &corridor = {});
+    // time of the first visit of the cell after the start, -1 if there is none
+    static int getFirstVisit(const Path &path, int cell);
+    static int getManhattanDistance(int cell1, int cell2);
+
+    // BFS distances from all cells by target cell and the first cell of the blocked corridor
+    std::unordered_map<uint64_t, std::vector<int>> distances;
+};
+
+#endif // SYMMETRY_REASONING_H
@@ -0,0 +1,223 @@
+#include "wdg_heuristic.h"
+
+size_t WDGHeuristic::KeyHash::operator()(const Key &key) const {
+    size_t res = key.id1 * 73856093u ^ key.id2 * 19349663u ^ key.cost1 * 83492791u ^ key.cost2 * 40503u;
+    res ^= MDDCache::getHash(key.constraints1) + 0x9e3779b9 + (res << 6) + (res >> 2);
+    res ^= MDDCache::getHash(key.constraints2) + 0x9e3779b9 + (res << 6) + (res >> 2);
+    return res;
+}
+
+int WDGHeuristic::getHeuristic(const Map &map, const AgentSet &agentSet, const ConflictSet &conflictSet,
+                               const std::vector<int> &costs, const std::vector<MDD> &mdds,
+                               const std::vector<ConstraintsList> &constraints, MDDCache &mddCache,
+                               bool withWeights) {
+    // edges of the dependency graph, an agent pair is checked once even if it has several conflicts
+    std::vector<std::pair<int, int>> pairs;
+    std::vector<bool> cardinal;
+    auto addPairs = [&](const std::vector<Conflict> &conflicts, bool isCardinal) {
+        for (const Conflict &conflict : conflicts) {
+            std::pair<int, int> pair = std::minmax(conflict.id1, conflict.id2);
+            auto it = std::find(pairs.begin(), pairs.end(), pair);
+            if (it == pairs.end()) {
+                pairs.push_back(pair);
+                cardinal.push_back(isCardinal);
+            }
+        }
+    };
+    addPairs(conflictSet.getCardinalConflicts(), true);
+    addPairs(conflictSet.getSemiCardinalConflicts(), false);
+    addPairs(conflictSet.getNonCardinalConflicts(), false);
+
+    std::vector<Edge> edges;
+    std::unordered_map<int, int> indices;
+    for (int k = 0; k < int(pairs.size()); ++k) {
+        int weight = getWeight(map, agentSet, pairs[k].first, pairs[k].second, cardinal[k],
+                               costs, mdds, constraints, mddCache, withWeights);
+        if (weight > 0) {
+            edges.push_back({pairs[k].first, pairs[k].second, weight});
+            indices.emplace(pairs[k].first, indices.size());
+            indices.emplace(pairs[k].second, indices.size());
+        }
+    }
+
+    // the vertex cover is found for every connected component on its own
+    std::vector<int> component(indices.size());
+    for (int v = 0; v < int(component.size()); ++v) {
+        component[v] = v;
+    }
+    std::function<int(int)> find = [&](int v) {
+        return component[v] == v ? v : component[v] = find(component[v]);
+    };
+    for (Edge &edge : edges) {
+        edge.id1 = indices[edge.id1];
+        edge.id2 = indices[edge.id2];
+        int root1 = find(edge.id1), root2 = find(edge.id2);
+        component[root1] = root2;
+    }
+
+    int res = 0;
+    std::vector<int> localIndices(indices.size(), -1);
+    for (int root = 0; root < int(component.size()); ++root) {
+        if (find(root) != root) {
+            continue;
+        }
+        int n = 0;
+        for (int v = 0; v < int(component.size()); ++v) {
+            if (find(v) == root) {
+                localIndices[v] = n++;
+            }
+        }
+        std::vector<Edge> componentEdges;
+        for (const Edge &edge : edges) {
+            if (find(edge.id1) == root) {
+                componentEdges.push_back({localIndices[edge.id1], localIndices[edge.id2], edge.weight});
+            }
+        }
+        res += componentEdges.size() == 1 ? componentEdges[0].weight : getMinimumVertexCover(n, componentEdges);
+    }
+    return res;
+}
+
+void WDGHeuristic::clear() {
+    weights.clear();
+}
+
+int WDGHeuristic::getWeight(const Map &map, const AgentSet &agentSet, int id1, int id2, bool cardinal,
+                            const std::vector<int> &costs, const std::vector<MDD> &mdds,
+                            const std::vector<ConstraintsList> &constraints, MDDCache &mddCache,
+                            bool withWeights) {
+    Key key{id1, id2, costs[id1], costs[id2],
+            MDDCache::getConstraints(constraints[id1]), MDDCache::getConstraints(constraints[id2])};
+    auto it = weights.find(key);
+    if (it != weights.end()) {
+        return it->second;
+    }
+
+    // agents with a cardinal conflict have to increase the cost, so their current MDDs are not checked
+    int res;
+    if (!cardinal && MDD::hasConflictFreePaths(mdds[id1], mdds[id2], maxStates)) {
+        res = 0;
+    } else if (!withWeights) {
+        res = 1;
+    } else {
+        res = maxDelta + 1;
+        for (int delta = 1; delta <= maxDelta && res > maxDelta; ++delta) {
+            for (int delta1 = 0; delta1 <= delta; ++delta1) {
+                const MDD &mdd1 = getMDD(map, agentSet, id1, costs[id1] + delta1, constraints[id1], mddCache);
+                const MDD &mdd2 = getMDD(map, agentSet, id2, costs[id2] + delta - delta1, constraints[id2], mddCache);
+                if (MDD::hasConflictFreePaths(mdd1, mdd2, maxStates)) {
+                    res = delta;
+                    break;
+                }
+            }
+        }
+    }
+    weights.emplace(std::move(key), res);
+    return res;
+}
+
+const MDD& WDGHeuristic::getMDD(const Map &map, const AgentSet &agentSet, int agentId, int cost,
+                                const ConstraintsList &constraints, MDDCache &mddCache) {
+    MDD &mdd = mddCache.get(agentId, cost, constraints);
+    if (mdd.empty()) {
+        ConstraintsSet agentConstraints;
+        agentConstraints.addConstraints(constraints);
+        mdd = MDD(map, agentSet, agentId, cost, agentConstraints);
+    }
+    return mdd;
+}
+
+int WDGHeuristic::getMinimumVertexCover(int n, const std::vector<Edge> &edges) {
+    adjacent.assign(n, {});
+    for (const Edge &edge : edges) {
+        adjacent[edge.id1].emplace_back(edge.id2, edge.weight);
+        adjacent[edge.id2].emplace_back(edge.id1, edge.weight);
+    }
+    // vertices of high degree are fixed first, heavy edges are matched first in the lower bound
+    order.resize(n);
+    for (int v = 0; v < n; ++v) {
+        order[v] = v;
+    }
+    std::sort(order.begin(), order.end(), [this](int lhs, int rhs) {
+        return adjacent[lhs].size() > adjacent[rhs].size();
+    });
+    coverEdges = edges;
+    std::sort(coverEdges.begin(), coverEdges.end(), [](const Edge &lhs, const Edge &rhs) {
+        return lhs.weight > rhs.weight;
+    });
+
+    values.assign(n, -1);
+    lowerBounds.resize(n);
+    coverSum = 0;
+    coverCalls = 0;
+    bestCover = 0;
+    for (int v = 0; v < n; ++v) {
+        int maxWeight = 0;
+        for (auto &neighbour : adjacent[v]) {
+            maxWeight = std::max(maxWeight, neighbour.second);
+        }
+        bestCover += maxWeight;
+    }
+    int lowerBound = getLowerBound();
+    coverVertices(0);
+    return coverCalls > maxCoverCalls ? lowerBound : bestCover;
+}
+
+void WDGHeuristic::coverVertices(int k) {
+    if (++coverCalls > maxCoverCalls) {
+        return;
+    }
+    if (k == int(order.size())) {
+        bestCover = std::min(bestCover, coverSum);
+        return;
+    }
+    if (coverSum + getLowerBound() >= bestCover) {
+        return;
+    }
+
+    // the value of the vertex has to cover the edges to the fixed vertices, more than the heaviest edge is not needed
+    int v = order[k], minValue = 0, maxValue = 0;
+    for (auto &neighbour : adjacent[v]) {
+        if (values[neighbour.first] != -1) {
+            minValue = std::max(minValue, neighbour.second - values[neighbour.first]);
+        } else {
+            maxValue = std::max(maxValue, neighbour.second);
+        }
+    }
+    for (int value = std::max(minValue, maxValue); value >= minValue; --value) {
+        values[v] = value;
+        coverSum += value;
+        coverVertices(k + 1);
+        coverSum -= value;
+    }
+    values[v] = -1;
+}
+
+int WDGHeuristic::getLowerBound() {
+    // a free vertex needs at least the rest of the weights of its edges to the fixed vertices,
+    // the edges of a matching between free vertices need the rest of their weights on top of that
+    int res = 0;
+    for (int v = 0; v < int(values.size()); ++v) {
+        lowerBounds[v] = 0;
+        if (values[v] == -1) {
+            for (auto &neighbour : adjacent[v]) {
+                if (values[neighbour.first] != -1) {
+                    lowerBounds[v] = std::max(lowerBounds[v], neighbour.second - values[neighbour.first]);
+                }
+            }
+            res += lowerBounds[v];
+        }
+    }
+    std::vector<bool> matched(values.size(), false);
+    for (const Edge &edge : coverEdges) {
+        if (values[edge.id1] == -1 && values[edge.id2] == -1 && !matched[edge.id1] && !matched[edge.id2]) {
+            int rest = edge.weight - lowerBounds[edge.id1] - lowerBounds[edge.id2];
+            if (rest > 0) {
+                res += rest;
+                matched[edge.id1] = true;
+                matched[edge.id2] = true;
+            }
+        }
+    }
+    return res;
+}
@@ -0,0 +1,78 @@
+#ifndef WDG_HEURISTIC_H
+#define WDG_HEURISTIC_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include "map.h"
+#include "agent_set.h"
+#include "constraints_set.h"
+#include "conflict_set.h"
+#include "mdd.h"
+
+// Admissible heuristics of a CT node from the dependency graph of its agents. Two conflicting agents are dependent
+// if their MDDs have no pair of paths without conflicts, then the cost of the node has to grow to solve them.
+// In DG every edge between dependent agents has weight 1, in WDG the weight of an edge is the least increase
+// of the sum of the costs of the two agents that makes them independent, found by ICTS: all pairs of MDDs
+// of the costs with the given sum are checked for paths without conflicts. The heuristic is the weight
+// of the minimum edge-weighted vertex cover of the graph. The weights are cached by the agents and their constraints,
+// since most of the edges of a node are the same as in its parent.
+class WDGHeuristic
+{
+public:
+    int getHeuristic(const Map &map, const AgentSet &agentSet, const ConflictSet &conflictSet,
+                     const std::vector<int> &costs, const std::vector<MDD> &mdds,
+                     const std::vector<ConstraintsList> &constraints, MDDCache &mddCache, bool withWeights);
+    void clear();
+
+//private:
+    struct Key
+    {
+        int                     id1, id2, cost1, cost2;
+        std::vector<Constraint> constraints1, constraints2;  // sorted
+
+        bool operator== (const Key &other) const {
+            return id1 == other.id1 && id2 == other.id2 && cost1 == other.cost1 && cost2 == other.cost2 &&
+                   constraints1 == other.constraints1 && constraints2 == other.constraints2;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct Edge
+    {
+        int id1, id2, weight;
+    };
+
+    int getWeight(const Map &map, const AgentSet &agentSet, int id1, int id2, bool cardinal,
+                  const std::vector<int> &costs, const std::vector<MDD> &mdds,
+                  const std::vector<ConstraintsList> &constraints, MDDCache &mddCache, bool withWeights);
+    static const MDD& getMDD(const Map &map, const AgentSet &agentSet, int agentId, int cost,
+                             const ConstraintsList &constraints, MDDCache &mddCache);
+    // weight of the minimum vertex cover of a connected graph with vertices 0..n-1,
+    // a lower bound of it if the search runs out of calls
+    int getMinimumVertexCover(int n, const std::vector<Edge> &edges);
+    void coverVertices(int k);
+    int getLowerBound();
+
+    // ICTS stops at this increase of the sum of costs, the weight of the edge is then maxDelta + 1.
+    // A pair of MDDs is taken to have paths without conflicts if the search for them visits more than maxStates
+    // pairs of nodes, this can only make a weight smaller
+    static const int maxDelta = 4;
+    static const int maxStates = 1 << 16;
+    static const int maxCoverCalls = 100000;
+
+    std::unordered_map<Key, int, KeyHash>   weights;
+
+    // state of the search for the minimum vertex cover
+    std::vector<std::vector<std::pair<int, int>>>   adjacent;  // pairs (vertex, weight)
+    std::vector<int>                                order, values, lowerBounds;
+    std::vector<Edge>                               coverEdges;
+    int                                             coverSum, bestCover, coverCalls;
+};
+
+#endif // WDG_HEURISTIC_H